@@ -0,0 +1,201 @@
+#include "Trie.h"
+#include "DoubleArrayTrie.h"
+#include "BKTree.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+// Compares the fuzzy backends on one dictionary so the fastest one can be picked per project.
+// usage: Benchmarks [dictionary file] [query count] [max edits] [k]
+// Queries are dictionary words with up to max_edits random typos, generated from a fixed seed so that
+// runs on the same dictionary are comparable.
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	double elapsed_ms(Clock::time_point since)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+	}
+
+	std::vector<std::string> make_queries(const std::vector<std::pair<std::string, int>>& words, int count, int max_edits)
+	{
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<int> letter('a', 'z');
+		std::vector<std::string> queries;
+		if (words.empty()) return queries;
+
+		for (int q = 0; q < count; ++q) {
+			std::string query = words[rng() % words.size()].first;
+			int typos = static_cast<int>(rng() % (max_edits + 1));
+
+			for (int t = 0; t < typos; ++t) {
+				size_t position = query.empty() ? 0 : rng() % query.size();
+				switch (rng() % 3) {
+				case 0: // substitution
+					if (!query.empty()) query[position] = static_cast<char>(letter(rng));
+					break;
+				case 1: // insertion
+					query.insert(query.begin() + position, static_cast<char>(letter(rng)));
+					break;
+				default: // deletion
+					if (!query.empty()) query.erase(position, 1);
+					break;
+				}
+			}
+			queries.push_back(query);
+		}
+		return queries;
+	}
+
+	// The trie answers get_top_k_fuzzy_matches from its prefix completions without any fuzzy search, so its
+	// engines are timed on the full search they speed up, filtered down to the same answer
+	struct TrieSearch {
+		const Trie& trie;
+
+		std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+		{
+			std::vector<FuzzyMatch> matches = trie.get_ranked_fuzzy_matches(input, max_edits);
+			keep_prefix_matches(matches, trie.get_top_k_with_prefix(input, k), k);
+			return matches;
+		}
+	};
+
+	struct BackendResult {
+		std::string name;
+		double build_ms;
+		size_t memory;
+		double query_ms;
+		bool agrees;
+	};
+
+	bool same_matches(const std::vector<FuzzyMatch>& a, const std::vector<FuzzyMatch>& b)
+	{
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); ++i) {
+			if (a[i].word != b[i].word || a[i].edit_distance != b[i].edit_distance) return false;
+		}
+		return true;
+	}
+
+	// runs every query once and checks the answers against the reference backend
+	template <typename Backend>
+	BackendResult run_queries(const std::string& name, const Backend& backend, double build_ms, size_t memory,
+		const std::vector<std::string>& queries, int max_edits, int k, const std::vector<std::vector<FuzzyMatch>>& reference)
+	{
+		std::vector<std::vector<FuzzyMatch>> answers;
+		answers.reserve(queries.size());
+
+		Clock::time_point start = Clock::now();
+		for (const std::string& query : queries) {
+			answers.push_back(backend.get_top_k_fuzzy_matches(query, max_edits, k));
+		}
+		double query_ms = elapsed_ms(start);
+
+		bool agrees = true;
+		for (size_t i = 0; i < answers.size() && i < reference.size(); ++i) {
+			agrees = agrees && same_matches(answers[i], reference[i]);
+		}
+		return BackendResult{ name, build_ms, memory, query_ms, agrees };
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	std::string dictionary = argc > 1 ? argv[1] : "../Trie Tree Autocomplete Engine/dictionary.txt";
+	int query_count = argc > 2 ? std::atoi(argv[2]) : 1000;
+	int max_edits = argc > 3 ? std::atoi(argv[3]) : 2;
+	int k = argc > 4 ? std::atoi(argv[4]) : 5;
+	if (query_count <= 0 || max_edits < 0 || k <= 0) {
+		std::cerr << "usage: Benchmarks [dictionary file] [query count] [max edits] [k]\n"
+			<< "query count and k must be positive, max edits must not be negative.\n";
+		return 1;
+	}
+
+	Clock::time_point start = Clock::now();
+	Trie trie;
+	trie.load_from_file(dictionary);
+	double trie_build_ms = elapsed_ms(start);
+
+	std::vector<std::pair<std::string, int>> words = trie.get_all_words();
+	if (words.empty()) {
+		std::cerr << "Dictionary " << dictionary << " is empty.\n";
+		return 1;
+	}
+	std::vector<std::string> queries = make_queries(words, query_count, max_edits);
+
+	std::cout << "dictionary: " << dictionary << " (" << words.size() << " words, " << trie.node_count() << " trie nodes)\n";
+	std::cout << "queries: " << queries.size() << ", max edits: " << max_edits << ", k: " << k << "\n\n";
+
+	// the trie's own answer is the reference every other backend has to agree with
+	std::vector<std::vector<FuzzyMatch>> reference;
+	for (const std::string& query : queries) {
+		reference.push_back(trie.get_top_k_fuzzy_matches(query, max_edits, k));
+	}
+
+	std::vector<BackendResult> results;
+	results.push_back(run_queries("trie completions", trie, trie_build_ms, trie.memory_usage(), queries, max_edits, k, reference));
+
+	TrieSearch search{ trie };
+
+	const std::pair<const char*, FuzzyEngine> engines[] = {
+		{ "trie dp rows", FuzzyEngine::DP_ROWS },
+		{ "trie automaton", FuzzyEngine::AUTOMATON },
+		{ "trie bit-parallel", FuzzyEngine::BIT_PARALLEL },
+	};
+	for (const auto& engine : engines) {
+		trie.set_fuzzy_engine(engine.second);
+		results.push_back(run_queries(engine.first, search, trie_build_ms, trie.memory_usage(), queries, max_edits, k, reference));
+	}
+	trie.set_fuzzy_engine(FuzzyEngine::DP_ROWS);
+
+	{
+		// the same engine fanned out over the root's subtrees, one worker per hardware thread
+		ThreadPool pool;
+		trie.set_fuzzy_engine(FuzzyEngine::BIT_PARALLEL);
+		trie.set_fuzzy_thread_pool(&pool);
+		results.push_back(run_queries("trie bit-parallel x" + std::to_string(pool.size()), search, trie_build_ms, trie.memory_usage(), queries, max_edits, k, reference));
+		trie.set_fuzzy_thread_pool(nullptr);
+		trie.set_fuzzy_engine(FuzzyEngine::DP_ROWS);
+	}
+
+	start = Clock::now();
+	trie.enable_deletion_index(max_edits, 8);
+	double index_build_ms = elapsed_ms(start);
+	results.push_back(run_queries("trie + deletion index", search, trie_build_ms + index_build_ms, trie.memory_usage(), queries, max_edits, k, reference));
+	trie.disable_deletion_index();
+
+	start = Clock::now();
+	DoubleArrayTrie double_array = trie.freeze();
+	double double_array_build_ms = elapsed_ms(start);
+	results.push_back(run_queries("double-array trie", double_array, double_array_build_ms, double_array.memory_usage(), queries, max_edits, k, reference));
+
+	start = Clock::now();
+	BKTree bk_tree(words);
+	double bk_tree_build_ms = elapsed_ms(start);
+	results.push_back(run_queries("bk-tree", bk_tree, bk_tree_build_ms, bk_tree.memory_usage(), queries, max_edits, k, reference));
+
+	std::cout << std::left << std::setw(24) << "backend"
+		<< std::right << std::setw(12) << "build ms"
+		<< std::setw(12) << "memory KB"
+		<< std::setw(14) << "us/query"
+		<< "  agrees\n";
+
+	for (const BackendResult& result : results) {
+		std::cout << std::left << std::setw(24) << result.name
+			<< std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << result.build_ms
+			<< std::setw(12) << result.memory / 1024
+			<< std::setw(14) << result.query_ms * 1000.0 / queries.size()
+			<< "  " << (result.agrees ? "yes" : "NO") << "\n";
+	}
+
+	return 0;
+}
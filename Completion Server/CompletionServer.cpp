@@ -0,0 +1,218 @@
+#include "Trie.h"
+#include "ConcurrentTrie.h"
+#include "httplib.h"
+// the bundled json.hpp is only the top header of nlohmann/json and needs the library's include/ tree next to it,
+// so an installed copy (apt nlohmann-json3-dev, vcpkg nlohmann-json) is preferred
+#if defined(__has_include) && __has_include(<nlohmann/json.hpp>)
+#include <nlohmann/json.hpp>
+#else
+#include "json.hpp"
+#endif
+#include <iostream>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+
+// Serves completions over HTTP, so several editors on one machine can share a single loaded dictionary.
+// usage: CompletionServer [--dictionary file] [--host address] [--port number] [--threads count] [--max-edits count]
+//
+//     GET  /complete?prefix=st&k=5               {"prefix": "st", "completions": ["string", ...]}
+//     GET  /fuzzy?input=strng&max_edits=2&k=5    {"input": "strng", "matches": [{"word", "frequency", "edit_distance", "score"}, ...]}
+//     POST /select   {"word": "string"}          {"word": "string", "frequency": 12}
+//
+// The dictionary is loaded once into a Trie and served from a ConcurrentTrie: every worker thread answers
+// queries without taking a lock, and selections are applied while they run. Learned frequencies live in memory
+// only, the dictionary file is never written.
+
+using json = nlohmann::json;
+
+namespace {
+
+	const int DEFAULT_K = 5;
+	const int DEFAULT_MAX_EDITS = 2;
+	const int MAX_K = 100;
+	const size_t MAX_QUERY_LENGTH = 64; // longer inputs cannot be identifiers worth completing
+
+	struct ServerOptions {
+		std::string dictionary = "dictionary.txt";
+		std::string host = "127.0.0.1";
+		int port = 8080;
+		unsigned threads = 0; // one per hardware thread
+		int max_edits = 3;    // fuzzy queries asking for more are refused, their cost grows steeply
+	};
+
+	bool parse_options(int argc, char* argv[], ServerOptions& options)
+	{
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (i + 1 >= argc) {
+				std::cerr << "Missing value for " << option << ".\n";
+				return false;
+			}
+			std::string value = argv[++i];
+
+			if (option == "--dictionary") options.dictionary = value;
+			else if (option == "--host") options.host = value;
+			else if (option == "--port") options.port = std::atoi(value.c_str());
+			else if (option == "--threads") options.threads = static_cast<unsigned>(std::atoi(value.c_str()));
+			else if (option == "--max-edits") options.max_edits = std::atoi(value.c_str());
+			else {
+				std::cerr << "Unknown option " << option << ".\n";
+				return false;
+			}
+		}
+
+		if (options.threads == 0) options.threads = std::thread::hardware_concurrency();
+		if (options.threads == 0) options.threads = 1;
+		return true;
+	}
+
+	void send_json(httplib::Response& response, const json& body, int status = 200)
+	{
+		response.status = status;
+		response.set_content(body.dump(), "application/json");
+	}
+
+	void send_error(httplib::Response& response, int status, const std::string& message)
+	{
+		send_json(response, json{ { "error", message } }, status);
+	}
+
+	// a small non-negative integer parameter, fallback when it is absent; false when it is malformed or out of range
+	bool read_int(const httplib::Request& request, const char* name, int fallback, int low, int high, int& value)
+	{
+		value = fallback;
+		if (!request.has_param(name)) return true;
+
+		std::string text = request.get_param_value(name);
+		if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+		value = std::atoi(text.c_str());
+		return value >= low && value <= high;
+	}
+
+	// lowercase letters only, as the Trie stores them
+	bool is_query(const std::string& text)
+	{
+		if (text.size() > MAX_QUERY_LENGTH) return false;
+		for (char ch : text) {
+			if (ch < 'a' || ch > 'z') return false;
+		}
+		return true;
+	}
+
+	void handle_complete(const ConcurrentTrie& dictionary, const httplib::Request& request, httplib::Response& response)
+	{
+		std::string prefix = request.get_param_value("prefix");
+		int k;
+		if (!is_query(prefix)) {
+			send_error(response, 400, "prefix must be up to 64 lowercase letters");
+			return;
+		}
+		if (!read_int(request, "k", DEFAULT_K, 1, MAX_K, k)) {
+			send_error(response, 400, "k must be between 1 and 100");
+			return;
+		}
+
+		send_json(response, json{ { "prefix", prefix }, { "completions", dictionary.get_top_k_with_prefix(prefix, k) } });
+	}
+
+	void handle_fuzzy(const ConcurrentTrie& dictionary, const ServerOptions& options, const httplib::Request& request, httplib::Response& response)
+	{
+		std::string input = request.get_param_value("input");
+		int max_edits;
+		int k;
+		if (!is_query(input)) {
+			send_error(response, 400, "input must be up to 64 lowercase letters");
+			return;
+		}
+		if (!read_int(request, "max_edits", std::min(DEFAULT_MAX_EDITS, options.max_edits), 0, options.max_edits, max_edits)) {
+			send_error(response, 400, "max_edits must be between 0 and " + std::to_string(options.max_edits));
+			return;
+		}
+		if (!read_int(request, "k", DEFAULT_K, 1, MAX_K, k)) {
+			send_error(response, 400, "k must be between 1 and 100");
+			return;
+		}
+
+		json matches = json::array();
+		for (const FuzzyMatch& match : dictionary.get_top_k_fuzzy_matches(input, max_edits, k)) {
+			matches.push_back(json{
+				{ "word", match.word },
+				{ "frequency", match.frequency },
+				{ "edit_distance", match.edit_distance },
+				{ "score", match.score } });
+		}
+		send_json(response, json{ { "input", input }, { "matches", matches } });
+	}
+
+	void handle_select(ConcurrentTrie& dictionary, const httplib::Request& request, httplib::Response& response)
+	{
+		json body = json::parse(request.body, nullptr, false);
+		if (body.is_discarded() || !body.is_object() || !body.contains("word") || !body["word"].is_string()) {
+			send_error(response, 400, "expected {\"word\": \"...\"}");
+			return;
+		}
+
+		std::string word = body["word"].get<std::string>();
+		if (!is_query(word)) {
+			send_error(response, 400, "word must be up to 64 lowercase letters");
+			return;
+		}
+		if (!dictionary.contains(word)) {
+			send_error(response, 404, "unknown word");
+			return;
+		}
+
+		dictionary.log_selection(word);
+		send_json(response, json{ { "word", word }, { "frequency", dictionary.frequency_of(word) } });
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	ServerOptions options;
+	if (!parse_options(argc, argv, options)) return 1;
+
+	auto load_start = std::chrono::steady_clock::now();
+	std::unique_ptr<ConcurrentTrie> dictionary;
+	size_t node_count;
+	{
+		// only needed for loading, the ConcurrentTrie keeps its own nodes
+		Trie trie;
+		trie.load_from_file_parallel(options.dictionary, options.threads);
+		if (trie.empty()) {
+			std::cerr << "No words to serve (" << options.dictionary << ").\n";
+			return 1;
+		}
+		dictionary.reset(new ConcurrentTrie(trie));
+		node_count = trie.node_count();
+	}
+	double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+
+	httplib::Server server;
+	unsigned threads = options.threads;
+	server.new_task_queue = [threads]() { return new httplib::ThreadPool(threads); };
+
+	server.Get("/complete", [&](const httplib::Request& request, httplib::Response& response) {
+		handle_complete(*dictionary, request, response);
+	});
+	server.Get("/fuzzy", [&](const httplib::Request& request, httplib::Response& response) {
+		handle_fuzzy(*dictionary, options, request, response);
+	});
+	server.Post("/select", [&](const httplib::Request& request, httplib::Response& response) {
+		handle_select(*dictionary, request, response);
+	});
+
+	std::cout << "Loaded " << node_count << " nodes from " << options.dictionary << " in " << load_ms << " ms.\n";
+	std::cout << "Serving on http://" << options.host << ":" << options.port << " with " << threads << " worker threads." << std::endl;
+
+	if (!server.listen(options.host, options.port)) {
+		std::cerr << "Could not listen on " << options.host << ":" << options.port << ".\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "Trie.h"
+#include "WorkloadGenerator.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+// Writes a synthetic identifier dictionary, and optionally a query stream over it, for load tests and benchmarks.
+// usage: DictionaryGenerator [--words count] [--style lower|snake|camel|mixed] [--zipf exponent] [--max-frequency number]
+//                            [--seed number] [--output file] [--format text|binary]
+//                            [--queries count] [--query-output file] [--query-mode prefix|word] [--typo-rate rate]
+//                            [--max-typos count] [--stream number]
+//
+// The same options write the same files on every machine, see WorkloadGenerator. A binary dictionary is built
+// through a Trie and can be opened by MappedDictionary; either format loads with Trie::load_from_file.
+// Query lines are "input word typos": what was typed, the word that was meant, and how many typos were made.
+
+namespace {
+
+	struct GeneratorOptions {
+		WorkloadOptions workload;
+		std::string output = "generated_dictionary.txt";
+		DictionaryFormat format = DictionaryFormat::TEXT;
+		QueryOptions queries{};
+		std::string query_output = "generated_queries.txt";
+	};
+
+	bool parse_options(int argc, char* argv[], GeneratorOptions& options)
+	{
+		options.queries.count = 0; // no query stream unless one is asked for
+
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (i + 1 >= argc) {
+				std::cerr << "Missing value for " << option << ".\n";
+				return false;
+			}
+			std::string value = argv[++i];
+
+			bool valid = true;
+			if (option == "--words") options.workload.words = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--zipf") options.workload.zipf_exponent = std::atof(value.c_str());
+			else if (option == "--max-frequency") options.workload.max_frequency = std::atoi(value.c_str());
+			else if (option == "--seed") options.workload.seed = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--output") options.output = value;
+			else if (option == "--queries") options.queries.count = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--query-output") options.query_output = value;
+			else if (option == "--typo-rate") options.queries.typo_rate = std::atof(value.c_str());
+			else if (option == "--max-typos") options.queries.max_typos = std::atoi(value.c_str());
+			else if (option == "--stream") options.queries.stream = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--style") {
+				if (value == "lower") options.workload.style = IdentifierStyle::LOWER;
+				else if (value == "snake") options.workload.style = IdentifierStyle::SNAKE;
+				else if (value == "camel") options.workload.style = IdentifierStyle::CAMEL;
+				else if (value == "mixed") options.workload.style = IdentifierStyle::MIXED;
+				else valid = false;
+			}
+			else if (option == "--format") {
+				if (value == "text") options.format = DictionaryFormat::TEXT;
+				else if (value == "binary") options.format = DictionaryFormat::BINARY;
+				else valid = false;
+			}
+			else if (option == "--query-mode") {
+				if (value == "prefix") options.queries.whole_words = false;
+				else if (value == "word") options.queries.whole_words = true;
+				else valid = false;
+			}
+			else {
+				std::cerr << "Unknown option " << option << ".\n";
+				return false;
+			}
+			if (!valid) {
+				std::cerr << "Unknown value " << value << " for " << option << ".\n";
+				return false;
+			}
+		}
+
+		if (options.workload.words == 0 || options.workload.words >= UINT32_MAX) {
+			std::cerr << "--words must be between 1 and " << UINT32_MAX - 1 << ".\n";
+			return false;
+		}
+		if (options.workload.zipf_exponent < 0 || options.workload.max_frequency <= 0) {
+			std::cerr << "--zipf must not be negative and --max-frequency must be positive.\n";
+			return false;
+		}
+		if (options.queries.typo_rate < 0 || options.queries.typo_rate > 1 || options.queries.max_typos < 0) {
+			std::cerr << "--typo-rate must be between 0 and 1 and --max-typos must not be negative.\n";
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	GeneratorOptions options;
+	if (!parse_options(argc, argv, options)) return 1;
+
+	auto start = std::chrono::steady_clock::now();
+	WorkloadGenerator generator(options.workload);
+	std::cout << "Generated " << generator.size() << " words in "
+		<< std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s.\n";
+
+	if (options.format == DictionaryFormat::TEXT) {
+		if (!generator.save_dictionary(options.output)) return 1;
+	}
+	else {
+		Trie trie;
+		trie.load_words(generator.get_words());
+		trie.save_to_file(options.output, DictionaryFormat::BINARY);
+	}
+	std::cout << "Wrote " << options.output << ".\n";
+
+	if (options.queries.count > 0) {
+		if (!generator.save_queries(options.query_output, generator.make_queries(options.queries))) return 1;
+		std::cout << "Wrote " << options.queries.count << " queries to " << options.query_output << ".\n";
+	}
+	return 0;
+}
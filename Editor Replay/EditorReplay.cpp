@@ -0,0 +1,42 @@
+#include "EditorCore.h"
+#include <iostream>
+#include <string>
+
+// Replays a keystroke trace recorded by the console (--record) through EditorCore, on any platform.
+// usage: EditorReplay --trace file [--latencies file] [--output memory|null]
+//
+// Runs in the directory of the dictionary, like the console: dictionary.bin, or else dictionary.txt, and the
+// update log are loaded and left unchanged. The memory output renders every line as the console would, without
+// the console; the null output renders nothing, so the latencies are the editor's alone.
+
+int main(int argc, char* argv[])
+{
+	std::string trace_file, latency_file, output_name = "memory";
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "Missing value for " << option << ".\n";
+			return 1;
+		}
+		std::string value = argv[++i];
+
+		if (option == "--trace") trace_file = value;
+		else if (option == "--latencies") latency_file = value;
+		else if (option == "--output") output_name = value;
+		else {
+			std::cerr << "Unknown option " << option << ".\n";
+			return 1;
+		}
+	}
+	if (trace_file.empty() || (output_name != "memory" && output_name != "null")) {
+		std::cerr << "usage: EditorReplay --trace file [--latencies file] [--output memory|null]\n";
+		return 1;
+	}
+
+	MemoryOutput memory;
+	NullOutput null_output;
+	EditorCore editor(output_name == "null" ? static_cast<EditorOutput&>(null_output) : memory);
+
+	editor.open_dictionary(true);
+	return editor.replay_trace(trace_file, latency_file) ? 0 : 1;
+}
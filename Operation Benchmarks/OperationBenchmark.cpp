@@ -0,0 +1,283 @@
+#include "Trie.h"
+#include "WorkloadGenerator.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+// the bundled json.hpp needs the rest of nlohmann/json next to it, see the Completion Server
+#if defined(__has_include) && __has_include(<nlohmann/json.hpp>)
+#include <nlohmann/json.hpp>
+#else
+#include "json.hpp"
+#endif
+#ifdef _WIN32
+#define NOMINMAX // windows.h would turn std::min and std::max into macros
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Times every Trie operation over synthetic dictionaries of the given sizes and writes the results as JSON,
+// to compare builds before and after an engine change.
+// usage: OperationBenchmark [--sizes 10000,100000] [--queries count] [--k count] [--edits 0,1,2,3]
+//                           [--typo-rate rate] [--repeat count] [--seed number] [--output file]
+//
+// Single operations are timed one by one, so the percentiles are per operation; ops_per_sec covers the whole loop.
+// save_to_file and load_from_file are timed per file, repeat times. Dictionaries and queries come from
+// WorkloadGenerator with a fixed seed, so two runs with the same options measure the same work on any machine.
+// Peak RSS is the process high-water mark after each size, so it includes every smaller size run before it.
+
+using json = nlohmann::json;
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	struct BenchmarkOptions {
+		std::vector<size_t> sizes{ 10000, 100000 };
+		size_t queries = 10000;
+		int k = 5;
+		std::vector<int> edits{ 0, 1, 2, 3 };
+		double typo_rate = 0.1; // of the fuzzy queries, which make at most as many typos as the edits searched for
+		int repeat = 5;
+		uint64_t seed = 42;
+		std::string output; // stdout when empty
+	};
+
+	template <typename T>
+	bool parse_list(const std::string& text, std::vector<T>& values)
+	{
+		values.clear();
+		size_t start = 0;
+		while (start <= text.size()) {
+			size_t end = text.find(',', start);
+			if (end == std::string::npos) end = text.size();
+			std::string item = text.substr(start, end - start);
+			if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos) return false;
+			values.push_back(static_cast<T>(std::strtoull(item.c_str(), nullptr, 10)));
+			start = end + 1;
+		}
+		return !values.empty();
+	}
+
+	bool parse_options(int argc, char* argv[], BenchmarkOptions& options)
+	{
+		for (int i = 1; i < argc; ++i) {
+			std::string option = argv[i];
+			if (i + 1 >= argc) {
+				std::cerr << "Missing value for " << option << ".\n";
+				return false;
+			}
+			std::string value = argv[++i];
+
+			bool valid = true;
+			if (option == "--sizes") valid = parse_list(value, options.sizes);
+			else if (option == "--edits") valid = parse_list(value, options.edits);
+			else if (option == "--queries") options.queries = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--k") options.k = std::atoi(value.c_str());
+			else if (option == "--repeat") options.repeat = std::atoi(value.c_str());
+			else if (option == "--typo-rate") options.typo_rate = std::atof(value.c_str());
+			else if (option == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+			else if (option == "--output") options.output = value;
+			else {
+				std::cerr << "Unknown option " << option << ".\n";
+				return false;
+			}
+			if (!valid) {
+				std::cerr << "Expected a comma separated list of numbers for " << option << ".\n";
+				return false;
+			}
+		}
+
+		bool zero_size = std::find(options.sizes.begin(), options.sizes.end(), 0) != options.sizes.end();
+		if (zero_size || options.queries == 0 || options.k <= 0 || options.repeat <= 0) {
+			std::cerr << "--sizes, --queries, --k and --repeat must be positive.\n";
+			return false;
+		}
+		if (options.typo_rate < 0 || options.typo_rate > 1) {
+			std::cerr << "--typo-rate must be between 0 and 1.\n";
+			return false;
+		}
+		return true;
+	}
+
+	size_t peak_rss_bytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+		return static_cast<size_t>(usage.ru_maxrss); // bytes on macOS
+#else
+		return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+#endif
+	}
+
+	// runs operation(i) for i in [0, count), timing each call
+	template <typename Operation>
+	json measure(const std::string& name, size_t count, Operation operation)
+	{
+		std::vector<double> micros;
+		micros.reserve(count);
+
+		Clock::time_point loop_start = Clock::now();
+		for (size_t i = 0; i < count; ++i) {
+			Clock::time_point start = Clock::now();
+			operation(i);
+			micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - loop_start).count();
+
+		if (micros.empty()) {
+			// nothing was timed, so there are no latencies to report
+			std::cerr << "  " << name << ": 0 ops\n";
+			return json{
+				{ "operation", name },
+				{ "count", 0 },
+				{ "ops_per_sec", 0.0 },
+				{ "mean_us", nullptr },
+				{ "p50_us", nullptr },
+				{ "p90_us", nullptr },
+				{ "p99_us", nullptr },
+				{ "p999_us", nullptr },
+				{ "max_us", nullptr } };
+		}
+
+		std::sort(micros.begin(), micros.end());
+		auto percentile = [&micros](double p) {
+			return micros[std::min(micros.size() - 1, static_cast<size_t>(p * micros.size()))];
+		};
+		double total = 0;
+		for (double value : micros) total += value;
+
+		std::cerr << "  " << name << ": " << count << " ops, p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us\n";
+		return json{
+			{ "operation", name },
+			{ "count", count },
+			{ "ops_per_sec", seconds > 0 ? count / seconds : 0.0 },
+			{ "mean_us", total / count },
+			{ "p50_us", percentile(0.5) },
+			{ "p90_us", percentile(0.9) },
+			{ "p99_us", percentile(0.99) },
+			{ "p999_us", percentile(0.999) },
+			{ "max_us", micros.back() } };
+	}
+
+	// the inputs of a query stream over the generated dictionary
+	std::vector<std::string> query_inputs(const WorkloadGenerator& generator, const QueryOptions& query_options)
+	{
+		std::vector<std::string> inputs;
+		for (WorkloadQuery& query : generator.make_queries(query_options)) inputs.push_back(std::move(query.input));
+		return inputs;
+	}
+
+	json run_size(size_t size, const BenchmarkOptions& options)
+	{
+		WorkloadOptions workload;
+		workload.seed = options.seed;
+		workload.words = size;
+		WorkloadGenerator generator(workload);
+		std::cerr << size << " words\n";
+
+		json operations = json::array();
+		Trie trie;
+		operations.push_back(measure("insert", generator.size(), [&](size_t i) {
+			trie.insert(generator.dictionary_word(i), generator.frequency(i));
+		}));
+
+		// queries pick their words with the dictionary's skew, every kind of query is a stream of its own
+		QueryOptions query_options;
+		query_options.count = options.queries;
+
+		std::vector<std::string> prefixes = query_inputs(generator, query_options);
+		operations.push_back(measure("get_top_k_with_prefix", prefixes.size(), [&](size_t i) {
+			trie.get_top_k_with_prefix(prefixes[i], options.k);
+		}));
+
+		for (int max_edits : options.edits) {
+			query_options.stream = 2 + max_edits;
+			query_options.whole_words = true;
+			query_options.typo_rate = options.typo_rate;
+			query_options.max_typos = max_edits;
+			std::vector<std::string> inputs = query_inputs(generator, query_options);
+			operations.push_back(measure("get_top_k_fuzzy_matches/" + std::to_string(max_edits), inputs.size(), [&](size_t i) {
+				trie.get_top_k_fuzzy_matches(inputs[i], max_edits, options.k);
+			}));
+		}
+
+		query_options.stream = 1;
+		query_options.whole_words = true;
+		query_options.typo_rate = 0;
+		std::vector<std::string> selected = query_inputs(generator, query_options);
+		operations.push_back(measure("log_selection", selected.size(), [&](size_t i) {
+			trie.log_selection(selected[i]);
+		}));
+
+		const std::pair<const char*, DictionaryFormat> formats[] = {
+			{ "text", DictionaryFormat::TEXT },
+			{ "binary", DictionaryFormat::BINARY },
+		};
+		for (const auto& format : formats) {
+			std::string file = std::string("benchmark_dictionary.") + (format.second == DictionaryFormat::TEXT ? "txt" : "bin");
+			operations.push_back(measure(std::string("save_to_file/") + format.first, options.repeat, [&](size_t) {
+				trie.save_to_file(file, format.second);
+			}));
+			operations.push_back(measure(std::string("load_from_file/") + format.first, options.repeat, [&](size_t) {
+				Trie loaded;
+				loaded.load_from_file(file);
+			}));
+			std::remove(file.c_str());
+		}
+
+		return json{
+			{ "size", size },
+			{ "nodes", trie.node_count() },
+			{ "memory_bytes", trie.memory_usage() },
+			{ "peak_rss_bytes", peak_rss_bytes() },
+			{ "operations", operations } };
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	if (!parse_options(argc, argv, options)) return 1;
+
+	json report{
+		{ "config", {
+			{ "sizes", options.sizes },
+			{ "queries", options.queries },
+			{ "k", options.k },
+			{ "edits", options.edits },
+			{ "typo_rate", options.typo_rate },
+			{ "repeat", options.repeat },
+			{ "seed", options.seed } } },
+		{ "results", json::array() } };
+
+	for (size_t size : options.sizes) {
+		report["results"].push_back(run_size(size, options));
+	}
+
+	if (options.output.empty()) {
+		std::cout << report.dump(2) << "\n";
+		return 0;
+	}
+
+	std::ofstream out(options.output);
+	out << report.dump(2) << "\n";
+	if (!out) {
+		std::cerr << "Failed to write " << options.output << ".\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,169 @@
+#include "BKTree.h"
+#include "Trie.h"
+#include "MyersPattern.h"
+#include <queue>
+#include <algorithm>
+
+const uint32_t BKTree::ROOT;
+
+namespace {
+
+	// every distance goes through here: bit-parallel for patterns that fit a machine word, DP rows otherwise
+	class DistanceTo {
+
+	public:
+
+		explicit DistanceTo(const std::string& pattern) : pattern(pattern), myers(pattern.size() <= MyersPattern::MAX_LENGTH ? pattern : std::string()) {}
+
+		int operator()(const std::string& text) const {
+			if (pattern.size() <= MyersPattern::MAX_LENGTH) return myers.distance(text);
+
+			std::vector<int> row(pattern.size() + 1);
+			for (size_t i = 0; i < row.size(); ++i) row[i] = static_cast<int>(i);
+			for (size_t j = 0; j < text.size(); ++j) {
+				int diagonal = row[0];
+				row[0] = static_cast<int>(j + 1);
+				for (size_t i = 1; i < row.size(); ++i) {
+					int above = row[i];
+					row[i] = std::min(std::min(row[i] + 1, row[i - 1] + 1), diagonal + (pattern[i - 1] == text[j] ? 0 : 1));
+					diagonal = above;
+				}
+			}
+			return row.back();
+		}
+
+	private:
+
+		const std::string& pattern;
+		MyersPattern myers;
+	};
+
+}
+
+BKTree::BKTree(const std::vector<std::pair<std::string, int>>& sorted_words)
+{
+	build(sorted_words);
+}
+
+BKTree::BKTree(const Trie& trie)
+{
+	build(trie.get_all_words());
+}
+
+void BKTree::build(const std::vector<std::pair<std::string, int>>& sorted_words)
+{
+	words.reserve(sorted_words.size());
+	frequencies.reserve(sorted_words.size());
+	for (const std::pair<std::string, int>& word : sorted_words) {
+		words.push_back(word.first);
+		frequencies.push_back(word.second);
+	}
+
+	first_edge.assign(words.size() + 1, 0);
+	if (words.empty()) return;
+
+	// classic insertion with growable child lists, flattened into edges once the shape is final
+	std::vector<std::vector<Edge>> children(words.size());
+	for (uint32_t id = 1; id < words.size(); ++id) {
+		DistanceTo distance_to(words[id]);
+		uint32_t node = ROOT;
+
+		while (true) {
+			int distance = distance_to(words[node]);
+			std::vector<Edge>& edges_of_node = children[node];
+
+			auto it = std::find_if(edges_of_node.begin(), edges_of_node.end(), [distance](const Edge& edge) { return edge.distance == distance; });
+			if (it == edges_of_node.end()) {
+				edges_of_node.push_back(Edge{ distance, id });
+				break;
+			}
+			node = it->child;
+		}
+	}
+
+	edges.reserve(words.size() - 1);
+	for (size_t node = 0; node < words.size(); ++node) {
+		std::sort(children[node].begin(), children[node].end(), [](const Edge& a, const Edge& b) { return a.distance < b.distance; });
+		first_edge[node] = static_cast<uint32_t>(edges.size());
+		edges.insert(edges.end(), children[node].begin(), children[node].end());
+	}
+	first_edge[words.size()] = static_cast<uint32_t>(edges.size());
+}
+
+std::vector<std::string> BKTree::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	// the node array is the sorted word list, so the words with a prefix are one contiguous range
+	auto begin = std::lower_bound(words.begin(), words.end(), prefix);
+	auto end = begin;
+	while (end != words.end() && end->compare(0, prefix.size(), prefix) == 0) ++end;
+
+	auto cmp = [](const auto& a, const auto& b) {
+		// max heap based on frequency
+		return a.second < b.second || (a.second == b.second && a.first > b.first);
+		};
+
+	std::priority_queue <
+		std::pair<std::string, int>,
+		std::vector<std::pair<std::string, int>>,
+		decltype(cmp)
+	> pq(cmp);
+
+	for (auto it = begin; it != end; ++it) {
+		pq.emplace(*it, frequencies[it - words.begin()]);
+	}
+
+	std::vector<std::string> result;
+	for (int i = 0; i < k && !pq.empty(); i++) {
+		result.push_back(pq.top().first);
+		pq.pop();
+	}
+	return result;
+}
+
+std::vector<FuzzyMatch> BKTree::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+{
+	std::vector<FuzzyMatch> all_matches = get_ranked_fuzzy_matches(input, max_edits);
+
+	std::vector<std::string> words_with_prefix = this->get_top_k_with_prefix(input, k);
+	keep_prefix_matches(all_matches, words_with_prefix, k);
+
+	return all_matches;
+}
+
+std::vector<FuzzyMatch> BKTree::get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha) const
+{
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	if (words.empty() || max_edits < 0) return {};
+
+	DistanceTo distance_to(input);
+	std::vector<uint32_t> pending{ ROOT };
+
+	while (!pending.empty()) {
+		uint32_t node = pending.back();
+		pending.pop_back();
+
+		int distance = distance_to(words[node]);
+		if (distance <= max_edits) {
+			result_map[words[node]] = FuzzyMatch{ words[node], frequencies[node], distance };
+		}
+
+		// triangle inequality: only children at distance - max_edits .. distance + max_edits from this word can match
+		auto first = edges.begin() + first_edge[node];
+		auto last = edges.begin() + first_edge[node + 1];
+		auto it = std::lower_bound(first, last, distance - max_edits, [](const Edge& edge, int value) { return edge.distance < value; });
+		for (; it != last && it->distance <= distance + max_edits; ++it) {
+			pending.push_back(it->child);
+		}
+	}
+
+	return rank_fuzzy_matches(result_map, alpha);
+}
+
+size_t BKTree::memory_usage() const
+{
+	size_t total = words.capacity() * sizeof(std::string) + frequencies.capacity() * sizeof(int);
+	for (const std::string& word : words) {
+		total += word.capacity();
+	}
+	return total + first_edge.capacity() * sizeof(uint32_t) + edges.capacity() * sizeof(Edge);
+}
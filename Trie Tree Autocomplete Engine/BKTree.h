@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "FuzzyMatch.h"
+
+class Trie;
+
+
+// Read-only BK-tree (Burkhard-Keller metric tree) over edit distance, an alternative fuzzy backend to the trie.
+// Every node holds one word, and a child hangs off the edge labelled with its distance to the parent word.
+// By the triangle inequality, a word within max_edits of the query can only sit below the edges whose label
+// is within max_edits of the distance between the query and the node, so the other subtrees are skipped.
+// Unlike the trie traversals, the work does not depend on how many words share a prefix with the query,
+// which suits dictionaries of long symbols that differ late; short words with many neighbours favour the trie.
+class BKTree {
+
+public:
+
+	BKTree() = default;
+
+	// words must be sorted and unique, which is what Trie::get_all_words produces
+	explicit BKTree(const std::vector<std::pair<std::string, int>>& sorted_words);
+	explicit BKTree(const Trie& trie);
+
+	// same ranking and prefix filtering as Trie::get_top_k_fuzzy_matches
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+
+	size_t word_count() const { return words.size(); }
+	size_t memory_usage() const;
+
+private:
+
+	static const uint32_t ROOT = 0;
+
+	// the sorted word list doubles as the node array: node i holds words[i], the root is the first word inserted
+	std::vector<std::string> words;
+	std::vector<int> frequencies;
+
+	// children of node i are edges[first_edge[i], first_edge[i + 1]), sorted by distance
+	struct Edge {
+		int distance;
+		uint32_t child;
+	};
+	std::vector<uint32_t> first_edge;
+	std::vector<Edge> edges;
+
+	void build(const std::vector<std::pair<std::string, int>>& sorted_words);
+
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
+};
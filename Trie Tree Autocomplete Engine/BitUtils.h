@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// small portable wrappers around the hardware bit counting instructions
+
+inline int popcount32(uint32_t x)
+{
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt(x));
+#else
+	return __builtin_popcount(x);
+#endif
+}
+
+inline int popcount64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(x));
+#elif defined(_MSC_VER)
+	return popcount32(static_cast<uint32_t>(x)) + popcount32(static_cast<uint32_t>(x >> 32));
+#else
+	return __builtin_popcountll(x);
+#endif
+}
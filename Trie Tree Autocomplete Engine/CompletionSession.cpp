@@ -0,0 +1,61 @@
+#include "CompletionSession.h"
+#include <algorithm>
+
+CompletionSession::CompletionSession(const Trie& trie, int max_edits, int k)
+	: trie(trie), max_edits(max_edits), k(k), cursors{ trie.root }, trie_nodes(trie.node_count())
+{
+}
+
+void CompletionSession::push(char ch)
+{
+	refresh();
+	word.push_back(ch);
+	const Trie::TrieNode* cursor = cursors.back();
+	cursors.push_back(cursor ? trie.child(cursor, ch - 'a') : nullptr);
+}
+
+void CompletionSession::pop()
+{
+	if (word.empty()) return;
+	word.pop_back();
+	cursors.pop_back();
+}
+
+void CompletionSession::clear()
+{
+	word.clear();
+	cursors.resize(1);
+}
+
+void CompletionSession::set_word(const std::string& new_word)
+{
+	size_t shared = std::mismatch(word.begin(), word.begin() + std::min(word.size(), new_word.size()), new_word.begin()).first - word.begin();
+	while (word.size() > shared) pop();
+	for (size_t i = shared; i < new_word.size(); ++i) push(new_word[i]);
+}
+
+void CompletionSession::refresh()
+{
+	if (trie.node_count() == trie_nodes) return;
+
+	// words were added: cursors that had left the trie may have a node now
+	trie_nodes = trie.node_count();
+	cursors.assign(1, trie.root);
+	for (char ch : word) {
+		const Trie::TrieNode* cursor = cursors.back();
+		cursors.push_back(cursor ? trie.child(cursor, ch - 'a') : nullptr);
+	}
+}
+
+std::vector<std::string> CompletionSession::get_top_k_with_prefix()
+{
+	refresh();
+	if (!cursors.back()) return std::vector<std::string>();
+	return trie.get_top_k_below(cursors.back(), word, k);
+}
+
+std::vector<FuzzyMatch> CompletionSession::get_top_k_fuzzy_matches()
+{
+	// the prefix-filtered result follows from the completions alone
+	return trie.fuzzy_matches_from_completions(word, get_top_k_with_prefix(), max_edits, k);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Trie.h"
+#include "FuzzyMatch.h"
+
+
+// Completion state of the word being typed, kept from one keystroke to the next.
+//
+// The prefix cursors hold the trie node of every prefix of the word, so a prefix query starts at its node and
+// backspace only drops the last one. Fuzzy queries need nothing more: the Trie keeps only the fuzzy matches that
+// are also top prefix completions, and a completion is exactly as many edits away as it has extra letters, so they
+// follow from the prefix query without a fuzzy walk (see Trie::fuzzy_matches_from_completions).
+// Results are the same as the Trie's.
+class CompletionSession {
+
+public:
+
+	CompletionSession(const Trie& trie, int max_edits, int k);
+
+	void push(char ch);
+	void pop();
+	void clear();
+
+	// pops back to the prefix shared with word and pushes the rest, so the cursors of that prefix are kept
+	void set_word(const std::string& word);
+	const std::string& get_word() const { return word; }
+
+	std::vector<std::string> get_top_k_with_prefix();
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches();
+
+private:
+
+	const Trie& trie;
+	int max_edits;
+	int k;
+
+	std::string word;
+	std::vector<const Trie::TrieNode*> cursors; // cursors[i] is the node of word[0, i), nullptr once it leaves the trie
+
+	// the trie only ever grows, and only new nodes make the cursors stale (frequencies are read at query time)
+	size_t trie_nodes;
+
+	void refresh();
+};
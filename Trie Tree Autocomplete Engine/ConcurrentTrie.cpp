@@ -0,0 +1,336 @@
+#include "ConcurrentTrie.h"
+#include "Trie.h"
+#include "BitUtils.h"
+#include <queue>
+#include <algorithm>
+#include <cctype>
+#include <new>
+
+const int ConcurrentTrie::NO_WORDS;
+
+ConcurrentTrie::Node* ConcurrentTrie::Node::create(uint32_t child_mask)
+{
+	static_assert(sizeof(Node) % alignof(const Node*) == 0, "the child array right after a node must be aligned");
+	void* memory = ::operator new(sizeof(Node) + popcount32(child_mask) * sizeof(const Node*));
+	return new (memory) Node{ child_mask, 0, NO_WORDS, false };
+}
+
+const ConcurrentTrie::Node* ConcurrentTrie::Node::child(size_t index) const
+{
+	if (index >= 26 || !((child_mask >> index) & 1u)) return nullptr;
+	return children()[popcount32(child_mask & ((1u << index) - 1))];
+}
+
+ConcurrentTrie::ConcurrentTrie() : root(Node::create(0))
+{
+}
+
+ConcurrentTrie::ConcurrentTrie(const Trie& trie)
+{
+	std::vector<std::pair<std::string, int>> words = trie.get_all_words();
+	root.store(build(words, 0, words.size(), 0));
+}
+
+ConcurrentTrie::~ConcurrentTrie()
+{
+	// no reader may be running any more, the retired nodes go with the reclaimer
+	destroy_tree(root.load());
+}
+
+ConcurrentTrie::Node* ConcurrentTrie::build(const std::vector<std::pair<std::string, int>>& words, size_t begin, size_t end, size_t depth)
+{
+	// words[begin, end) share their first depth letters and are sorted, so the word ending here comes first
+	bool ends_here = begin < end && words[begin].first.size() == depth;
+
+	uint32_t child_mask = 0;
+	std::vector<size_t> bounds;
+	for (size_t i = ends_here ? begin + 1 : begin; i < end;) {
+		char ch = words[i].first[depth];
+		bounds.push_back(i);
+		while (i < end && words[i].first[depth] == ch) ++i;
+		child_mask |= 1u << (ch - 'a');
+	}
+	bounds.push_back(end);
+
+	Node* node = Node::create(child_mask);
+	if (ends_here) {
+		node->is_end_of_word = true;
+		node->frequency = words[begin].second;
+	}
+	for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+		node->children()[i] = build(words, bounds[i], bounds[i + 1], depth + 1);
+	}
+	node->max_frequency = subtree_max_frequency(node);
+	return node;
+}
+
+void ConcurrentTrie::destroy_tree(const Node* node)
+{
+	int child_count = popcount32(node->child_mask);
+	for (int i = 0; i < child_count; ++i) {
+		destroy_tree(node->children()[i]);
+	}
+	Node::destroy(const_cast<Node*>(node));
+}
+
+int ConcurrentTrie::subtree_max_frequency(const Node* node)
+{
+	int best = node->is_end_of_word ? node->frequency : NO_WORDS;
+	int child_count = popcount32(node->child_mask);
+	for (int i = 0; i < child_count; ++i) {
+		best = std::max(best, node->children()[i]->max_frequency);
+	}
+	return best;
+}
+
+ConcurrentTrie::Node* ConcurrentTrie::copy_with_child(const Node* node, size_t index, const Node* next)
+{
+	uint32_t old_mask = node ? node->child_mask : 0;
+	Node* copy = Node::create(old_mask | (1u << index));
+	if (node) {
+		copy->frequency = node->frequency;
+		copy->is_end_of_word = node->is_end_of_word;
+	}
+
+	int slot = 0;
+	for (size_t i = 0; i < 26; ++i) {
+		if (i == index) copy->children()[slot++] = next;
+		else if ((old_mask >> i) & 1u) copy->children()[slot++] = node->child(i);
+	}
+	copy->max_frequency = subtree_max_frequency(copy);
+	return copy;
+}
+
+void ConcurrentTrie::publish(const std::vector<const Node*>& path, const std::string& word, Node* leaf)
+{
+	leaf->max_frequency = subtree_max_frequency(leaf);
+
+	// copy the path bottom-up, every copy pointing at the copy below it and at the untouched siblings
+	const Node* replacement = leaf;
+	for (size_t depth = word.size(); depth-- > 0;) {
+		replacement = copy_with_child(path[depth], word[depth] - 'a', replacement);
+	}
+
+	// readers that loaded the old root keep walking the old path until they unpin
+	root.store(replacement);
+	for (const Node* old : path) {
+		if (old) reclaimer.retire(const_cast<Node*>(old), &Node::destroy);
+	}
+	reclaimer.collect();
+}
+
+void ConcurrentTrie::insert(const std::string& word, int freq)
+{
+	std::lock_guard<std::mutex> lock(writer);
+
+	std::string stored;
+	for (char ch : word) {
+		if (std::islower(ch)) stored.push_back(ch); // allow only small letters, like Trie::insert
+	}
+
+	// the existing nodes along the word, nullptr from where the word leaves the trie
+	std::vector<const Node*> path{ root.load() };
+	for (char ch : stored) {
+		path.push_back(path.back() ? path.back()->child(ch - 'a') : nullptr);
+	}
+
+	const Node* old_leaf = path.back();
+	Node* leaf = Node::create(old_leaf ? old_leaf->child_mask : 0);
+	if (old_leaf) std::copy(old_leaf->children(), old_leaf->children() + popcount32(old_leaf->child_mask), leaf->children());
+	leaf->is_end_of_word = true;
+	leaf->frequency = freq;
+
+	publish(path, stored, leaf);
+}
+
+void ConcurrentTrie::log_selection(const std::string& word)
+{
+	add_frequency(word, Trie::SELECTION_BONUS);
+}
+
+void ConcurrentTrie::add_frequency(const std::string& word, int delta)
+{
+	std::lock_guard<std::mutex> lock(writer);
+
+	std::vector<const Node*> path{ root.load() };
+	for (char ch : word) {
+		const Node* next = path.back()->child(ch - 'a');
+		if (!next) return;
+		path.push_back(next);
+	}
+
+	const Node* old_leaf = path.back();
+	if (!old_leaf->is_end_of_word) return;
+
+	Node* leaf = Node::create(old_leaf->child_mask);
+	std::copy(old_leaf->children(), old_leaf->children() + popcount32(old_leaf->child_mask), leaf->children());
+	leaf->is_end_of_word = true;
+	leaf->frequency = old_leaf->frequency + delta;
+
+	publish(path, word, leaf);
+}
+
+size_t ConcurrentTrie::retired_count() const
+{
+	std::lock_guard<std::mutex> lock(writer);
+	return reclaimer.pending();
+}
+
+const ConcurrentTrie::Node* ConcurrentTrie::find_node(const Node* root, const std::string& word)
+{
+	const Node* node = root;
+	for (char ch : word) {
+		node = node->child(ch - 'a');
+		if (!node) return nullptr;
+	}
+	return node;
+}
+
+bool ConcurrentTrie::contains(const std::string& word) const
+{
+	EpochReclaimer::Guard guard(reclaimer);
+	const Node* node = find_node(root.load(), word);
+	return node && node->is_end_of_word;
+}
+
+int ConcurrentTrie::frequency_of(const std::string& word) const
+{
+	EpochReclaimer::Guard guard(reclaimer);
+	const Node* node = find_node(root.load(), word);
+	return node && node->is_end_of_word ? node->frequency : 0;
+}
+
+std::vector<std::string> ConcurrentTrie::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	EpochReclaimer::Guard guard(reclaimer);
+	return get_top_k_with_prefix(root.load(), prefix, k);
+}
+
+std::vector<std::string> ConcurrentTrie::get_top_k_with_prefix(const Node* root, const std::string& prefix, int k)
+{
+	// the same best-first branch and bound as Trie::get_top_k_with_prefix, over one published version
+	std::vector<std::string> result;
+
+	const Node* node = find_node(root, prefix);
+	if (!node || k <= 0 || node->max_frequency == NO_WORDS) return result;
+
+	struct Candidate {
+		int value;
+		std::string text;
+		const Node* node; // nullptr for a finished word
+	};
+
+	auto cmp = [](const Candidate& a, const Candidate& b) {
+		return a.value < b.value || (a.value == b.value && a.text > b.text);
+		};
+
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(cmp)> pq(cmp);
+	pq.push(Candidate{ node->max_frequency, prefix, node });
+
+	while (!pq.empty() && (int)result.size() < k) {
+		Candidate top = pq.top();
+		pq.pop();
+
+		if (top.node == nullptr) {
+			result.push_back(top.text);
+			continue;
+		}
+
+		if (top.node->is_end_of_word) {
+			pq.push(Candidate{ top.node->frequency, top.text, nullptr });
+		}
+		for (char ch = 'a'; ch <= 'z'; ++ch) {
+			const Node* next = top.node->child(ch - 'a');
+			if (next) {
+				pq.push(Candidate{ next->max_frequency, top.text + ch, next });
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<FuzzyMatch> ConcurrentTrie::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+{
+	EpochReclaimer::Guard guard(reclaimer);
+	const Node* version = root.load(); // the fuzzy search and the prefix filter must see the same words
+
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	if (max_edits >= 0) {
+		// the row for the empty path: reaching input[0, i) takes i deletions
+		std::vector<int> rows(input.size() + 1);
+		for (size_t i = 0; i < rows.size(); ++i) {
+			rows[i] = static_cast<int>(i);
+		}
+		std::string current;
+		search_fuzzy(version, input, current, rows, max_edits, result_map);
+	}
+	std::vector<FuzzyMatch> all_matches = rank_fuzzy_matches(result_map, 1);
+
+	std::vector<std::string> words_with_prefix = get_top_k_with_prefix(version, input, k);
+	keep_prefix_matches(all_matches, words_with_prefix, k);
+
+	return all_matches;
+}
+
+void ConcurrentTrie::search_fuzzy(const Node* node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results)
+{
+	// Levenshtein DP rows stacked per depth, as in Trie::search_fuzzy
+	const size_t width = target.size() + 1;
+	const size_t row = current.size() * width;
+	const size_t next_row = row + width;
+
+	if (node->is_end_of_word && rows[row + width - 1] <= max_edits) {
+		results[current] = FuzzyMatch{ current, node->frequency, rows[row + width - 1] };
+	}
+
+	if (rows.size() < next_row + width) {
+		rows.resize(next_row + width);
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		const Node* next = node->child(ch - 'a');
+		if (!next) continue;
+
+		rows[next_row] = rows[row] + 1;
+		int row_min = rows[next_row];
+
+		for (size_t j = 1; j < width; ++j) {
+			int substitution = rows[row + j - 1] + (target[j - 1] == ch ? 0 : 1);
+			int insertion = rows[row + j] + 1;
+			int deletion = rows[next_row + j - 1] + 1;
+			rows[next_row + j] = std::min(substitution, std::min(insertion, deletion));
+			row_min = std::min(row_min, rows[next_row + j]);
+		}
+
+		if (row_min > max_edits) continue;
+
+		current.push_back(ch);
+		search_fuzzy(next, target, current, rows, max_edits, results);
+		current.pop_back();
+	}
+}
+
+std::vector<std::pair<std::string, int>> ConcurrentTrie::get_all_words() const
+{
+	EpochReclaimer::Guard guard(reclaimer);
+	std::vector<std::pair<std::string, int>> words;
+	std::string current;
+	collect_all_words(root.load(), current, words);
+	return words;
+}
+
+void ConcurrentTrie::collect_all_words(const Node* node, std::string& current, std::vector<std::pair<std::string, int>>& out)
+{
+	if (node->is_end_of_word) {
+		out.emplace_back(current, node->frequency);
+	}
+
+	int child_count = popcount32(node->child_mask);
+	for (int i = 0, slot = 0; i < 26 && slot < child_count; ++i) {
+		if (!((node->child_mask >> i) & 1u)) continue;
+		current.push_back(static_cast<char>('a' + i));
+		collect_all_words(node->children()[slot++], current, out);
+		current.pop_back();
+	}
+}
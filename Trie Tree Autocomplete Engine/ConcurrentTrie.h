@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include "EpochReclaimer.h"
+#include "FuzzyMatch.h"
+
+class Trie;
+
+
+// Trie for serving completions from many threads while the dictionary keeps learning.
+// Nodes are immutable once published. A write copies the nodes on the path to the changed word (path copying),
+// links the copies to the untouched subtrees and swaps in the new root with a single atomic store, so a reader
+// that loaded the root sees one consistent version of the dictionary for its whole query.
+// Readers take no lock and never wait; writers are serialized by a mutex. The replaced path nodes are retired
+// to an EpochReclaimer and freed once no reader can still be walking them.
+// Queries follow the Trie's semantics exactly (best-first top-k over max_frequency, DP-row fuzzy search).
+class ConcurrentTrie {
+
+public:
+
+	ConcurrentTrie();
+	explicit ConcurrentTrie(const Trie& trie);
+	~ConcurrentTrie();
+
+	ConcurrentTrie(const ConcurrentTrie&) = delete;
+	ConcurrentTrie& operator=(const ConcurrentTrie&) = delete;
+
+	// readers, lock-free, from any number of threads
+
+	bool contains(const std::string& word) const;
+	int frequency_of(const std::string& word) const; // 0 when the word is not in the dictionary
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	// every word with its frequency, sorted lexicographically
+	std::vector<std::pair<std::string, int>> get_all_words() const;
+
+	// writers, serialized among themselves, never blocking a reader
+
+	void insert(const std::string& word, int freq = 1);
+	void log_selection(const std::string& word);
+
+	// adds delta to the frequency of an existing word, does nothing for a missing one
+	void add_frequency(const std::string& word, int delta);
+
+	// nodes replaced by writes that readers may still be walking
+	size_t retired_count() const;
+
+private:
+
+	static const int NO_WORDS = INT_MIN;
+
+	struct Node {
+		uint32_t child_mask; // bit i set when the child for 'a' + i exists
+		int frequency;
+		int max_frequency;   // highest frequency in the subtree, NO_WORDS when it holds no word
+		bool is_end_of_word;
+
+		// the children follow the node in the same allocation, densely in letter order like the Trie's child blocks
+		const Node** children() { return reinterpret_cast<const Node**>(this + 1); }
+		const Node* const* children() const { return reinterpret_cast<const Node* const*>(this + 1); }
+		const Node* child(size_t index) const;
+
+		static Node* create(uint32_t child_mask);
+		static void destroy(void* node) { ::operator delete(node); }
+	};
+
+	std::atomic<const Node*> root;
+
+	mutable EpochReclaimer reclaimer;
+	mutable std::mutex writer;
+
+	static Node* build(const std::vector<std::pair<std::string, int>>& words, size_t begin, size_t end, size_t depth);
+	static void destroy_tree(const Node* node);
+	static int subtree_max_frequency(const Node* node);
+
+	// copy of node (nullptr for a node that does not exist yet) with child index replaced by, or extended with, next
+	static Node* copy_with_child(const Node* node, size_t index, const Node* next);
+
+	// replaces the nodes of path (path[d] is the node for the first d letters of word, the last one is being
+	// replaced by leaf) with copies leading to leaf, publishes the new root and retires the old nodes
+	void publish(const std::vector<const Node*>& path, const std::string& word, Node* leaf);
+
+	static const Node* find_node(const Node* root, const std::string& word);
+	static std::vector<std::string> get_top_k_with_prefix(const Node* root, const std::string& prefix, int k);
+	static void search_fuzzy(const Node* node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results);
+	static void collect_all_words(const Node* node, std::string& current, std::vector<std::pair<std::string, int>>& out);
+};
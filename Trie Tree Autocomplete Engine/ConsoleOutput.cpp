@@ -0,0 +1,109 @@
+#include "ConsoleOutput.h"
+
+void ConsoleOutput::start_line()
+{
+    GetConsoleScreenBufferInfo(hConsole, &csbi);
+    initial_cursor_pos = csbi.dwCursorPosition;
+}
+
+void ConsoleOutput::new_line()
+{
+    std::cout << "\n"; // Move to next line
+
+    // Update initial_cursor_pos for the *new* line
+    start_line();
+}
+
+void ConsoleOutput::end_session()
+{
+    // Clear the line before exiting message
+    clear_input_area_and_reset_cursor(); // Use the more precise clear
+    std::cout << "Program exited\n";
+}
+
+void ConsoleOutput::clear_input_area_and_reset_cursor()
+{
+    COORD current_cursor_pos;
+    GetConsoleScreenBufferInfo(hConsole, &csbi);
+    current_cursor_pos = csbi.dwCursorPosition;
+
+    DWORD charsWritten;
+    DWORD conSize = csbi.dwSize.X - current_cursor_pos.X;
+    FillConsoleOutputCharacter(hConsole, ' ', conSize, current_cursor_pos, &charsWritten);
+    FillConsoleOutputAttribute(hConsole, csbi.wAttributes, conSize, current_cursor_pos, &charsWritten);
+
+    SetConsoleCursorPosition(hConsole, initial_cursor_pos);
+}
+
+WORD ConsoleOutput::token_color(TokenTYPE type)
+{
+    switch (type) {
+    case TokenTYPE::KEYWORD:
+        return COLOR_KEYWORD;
+    case TokenTYPE::STRING_LITERAL:
+        return COLOR_STRING;
+    case TokenTYPE::NUMBER_LITERAL:
+        return COLOR_NUMBER;
+    case TokenTYPE::COMMENT:
+        return COLOR_COMMENT;
+    case TokenTYPE::OPERATOR:
+        return COLOR_OPERATOR;
+    case TokenTYPE::PUNCTUATION:
+        return COLOR_PUNCTUATION;
+    case TokenTYPE::PREPROCESSOR:
+        return COLOR_PREPROCESSOR;
+    case TokenTYPE::DEFAULT:
+        // Fall through to use COLOR_DEFAULT (white)
+    default:
+        return COLOR_DEFAULT;
+    }
+}
+
+void ConsoleOutput::draw_line(int indent_columns, const std::vector<Token>& tokens, size_t cursor_from_end)
+{
+    // 1. Move cursor to the beginning of the line where the prompt started
+    SetConsoleCursorPosition(hConsole, initial_cursor_pos);
+
+    // 2. Get current console info to calculate area to clear
+    GetConsoleScreenBufferInfo(hConsole, &csbi);
+    DWORD charsWritten;
+
+    // 3. Clear the *entire* line from the prompt's start position to the end of the console line
+    // Reset color to default before clearing, to ensure the cleared space is default color
+    SetConsoleTextAttribute(hConsole, COLOR_DEFAULT);
+    DWORD conSize = csbi.dwSize.X - initial_cursor_pos.X;
+    FillConsoleOutputCharacter(hConsole, ' ', conSize, initial_cursor_pos, &charsWritten);
+    FillConsoleOutputAttribute(hConsole, COLOR_DEFAULT, conSize, initial_cursor_pos, &charsWritten);
+
+    // 4. Move cursor back to the prompt start to print the new line
+    SetConsoleCursorPosition(hConsole, initial_cursor_pos);
+
+    // 5. Print the "Input: " prompt with default color
+    SetConsoleTextAttribute(hConsole, COLOR_DEFAULT);
+    //std::cout << "Input: ";
+
+    // 6. Apply current indentation
+    for (int i = 0; i < indent_columns; ++i) {
+        std::cout << " "; // Print spaces for indentation (these also use default color)
+    }
+
+    // 7. Iterate through tokens and print with appropriate colors
+    size_t line_length = indent_columns;
+    for (const auto& token : tokens) {
+        WORD color_attribute = token_color(token.type);
+
+        SetConsoleTextAttribute(hConsole, color_attribute); // Set the color for this token
+        std::cout << token.text;                            // Print the token's text
+        line_length += token.text.length();
+    }
+
+    // 8. Reset color to default after printing the entire line
+    SetConsoleTextAttribute(hConsole, COLOR_DEFAULT);
+
+    // 9. Ensure cursor is at the end of the line (or cursor_from_end before it) + prompt + indentation
+    // This is typically handled by std::cout, but explicit setting can prevent issues.
+    COORD final_cursor_pos;
+    final_cursor_pos.X = static_cast<SHORT>(initial_cursor_pos.X + line_length - cursor_from_end);
+    final_cursor_pos.Y = initial_cursor_pos.Y;
+    SetConsoleCursorPosition(hConsole, final_cursor_pos);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include "EditorOutput.h"
+#include <windows.h> // Crucial for HANDLE, COORD, CONSOLE_SCREEN_BUFFER_INFO, etc.
+
+const WORD COLOR_DEFAULT = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE; // White
+const WORD COLOR_KEYWORD = FOREGROUND_BLUE | FOREGROUND_INTENSITY;              // Bright Blue
+const WORD COLOR_STRING = FOREGROUND_GREEN | FOREGROUND_RED;                    // Yellow (for strings, often green in IDEs)
+const WORD COLOR_NUMBER = FOREGROUND_RED | FOREGROUND_INTENSITY;                // Bright Red
+const WORD COLOR_COMMENT = FOREGROUND_GREEN | FOREGROUND_INTENSITY;             // Bright Green
+const WORD COLOR_OPERATOR = FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY; // Bright Magenta/Purple
+const WORD COLOR_PUNCTUATION = FOREGROUND_BLUE | FOREGROUND_RED;                // Magenta/Purple (less intense)
+const WORD COLOR_PREPROCESSOR = FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY; // Bright Cyan
+
+// EditorCore's output on the Windows console: the line is redrawn in place with its tokens colored.
+class ConsoleOutput : public EditorOutput {
+
+public:
+
+	// the input line starts at the cursor's current position
+	void start_line();
+
+	void draw_line(int indent_columns, const std::vector<Token>& tokens, size_t cursor_from_end) override;
+	void new_line() override;
+	void end_session() override;
+
+	static WORD token_color(TokenTYPE type);
+
+private:
+
+	HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+	CONSOLE_SCREEN_BUFFER_INFO csbi;
+	COORD initial_cursor_pos = {}; // where the input line starts
+
+	void clear_input_area_and_reset_cursor();
+};
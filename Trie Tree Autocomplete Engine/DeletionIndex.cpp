@@ -0,0 +1,87 @@
+#include "DeletionIndex.h"
+#include <unordered_set>
+#include <algorithm>
+
+DeletionIndex::DeletionIndex(int max_edits, size_t max_input_length)
+	: max_edits(std::max(0, max_edits)), max_input_length(max_input_length)
+{
+}
+
+void DeletionIndex::add(const std::string& word)
+{
+	// a longer word is more than max_edits insertions away from every input the index serves
+	if (word.size() > max_input_length + max_edits) return;
+
+	uint32_t id = static_cast<uint32_t>(words.size());
+	words.push_back(word);
+
+	for (const std::string& variant : deletion_variants(word, max_edits)) {
+		std::vector<uint32_t>& bucket = buckets[hash_variant(variant)];
+		// variants of one word are distinct, but two of them may still collide on the hash
+		if (bucket.empty() || bucket.back() != id) bucket.push_back(id);
+	}
+}
+
+std::vector<const std::string*> DeletionIndex::candidates(const std::string& input, int max_edits) const
+{
+	std::vector<const std::string*> result;
+	if (!covers(input, max_edits)) return result;
+
+	std::unordered_set<uint32_t> seen;
+	for (const std::string& variant : deletion_variants(input, max_edits)) {
+		auto it = buckets.find(hash_variant(variant));
+		if (it == buckets.end()) continue;
+
+		for (uint32_t id : it->second) {
+			if (seen.insert(id).second) result.push_back(&words[id]);
+		}
+	}
+	return result;
+}
+
+std::vector<std::string> DeletionIndex::deletion_variants(const std::string& word, int edits)
+{
+	// level by level: the strings of level e + 1 are the strings of level e with one more character deleted
+	std::unordered_set<std::string> seen{ word };
+	std::vector<std::string> variants{ word };
+	size_t level_begin = 0;
+
+	for (int e = 0; e < edits; ++e) {
+		size_t level_end = variants.size();
+		for (size_t v = level_begin; v < level_end; ++v) {
+			for (size_t i = 0; i < variants[v].size(); ++i) {
+				std::string shorter = variants[v];
+				shorter.erase(i, 1);
+				if (seen.insert(shorter).second) variants.push_back(std::move(shorter));
+			}
+		}
+		level_begin = level_end;
+	}
+	return variants;
+}
+
+uint64_t DeletionIndex::hash_variant(const std::string& variant)
+{
+	// FNV-1a, collisions only add candidates that the exact verification rejects
+	uint64_t hash = 14695981039346656037ull;
+	for (char ch : variant) {
+		hash ^= static_cast<uint8_t>(ch);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+size_t DeletionIndex::memory_usage() const
+{
+	size_t total = words.capacity() * sizeof(std::string);
+	for (const std::string& word : words) {
+		total += word.capacity();
+	}
+
+	// one hash node per variant plus the bucket array
+	total += buckets.bucket_count() * sizeof(void*);
+	for (const auto& bucket : buckets) {
+		total += sizeof(void*) + sizeof(bucket) + bucket.second.capacity() * sizeof(uint32_t);
+	}
+	return total;
+}
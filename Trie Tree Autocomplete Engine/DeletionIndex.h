@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+
+// SymSpell-style deletion neighbourhood index for short fuzzy queries.
+// Every word is stored under the hash of each string obtained by deleting up to max_edits of its characters.
+// Two strings within edit distance d always share such a variant (a substitution is one deletion on each side),
+// so the candidates for a query are the words filed under the query's own deletion variants: a few hash lookups
+// instead of a trie traversal. Candidates are a superset (hashes may collide, and sharing a variant only bounds
+// the distance by 2 * d), so the caller verifies them with the exact edit distance.
+// Only inputs of up to max_input_length characters are served, which means words longer than
+// max_input_length + max_edits can never match and are not indexed at all.
+class DeletionIndex {
+
+public:
+
+	DeletionIndex(int max_edits, size_t max_input_length);
+
+	// adds word to the index, a word must be added only once
+	void add(const std::string& word);
+
+	// true when a query with these parameters can be answered from the index
+	bool covers(const std::string& input, int max_edits) const {
+		return max_edits >= 0 && max_edits <= this->max_edits && input.size() <= max_input_length;
+	}
+
+	// every indexed word sharing a deletion variant (up to max_edits deletions) with input, each one once
+	std::vector<const std::string*> candidates(const std::string& input, int max_edits) const;
+
+	int get_max_edits() const { return max_edits; }
+	size_t get_max_input_length() const { return max_input_length; }
+
+	size_t word_count() const { return words.size(); }
+	size_t variant_count() const { return buckets.size(); }
+	size_t memory_usage() const;
+
+private:
+
+	int max_edits;
+	size_t max_input_length;
+
+	std::vector<std::string> words;
+	std::unordered_map<uint64_t, std::vector<uint32_t>> buckets; // variant hash -> ids of the words producing it
+
+	// all distinct strings reachable from word by deleting up to edits characters, word itself included
+	static std::vector<std::string> deletion_variants(const std::string& word, int edits);
+	static uint64_t hash_variant(const std::string& variant);
+};
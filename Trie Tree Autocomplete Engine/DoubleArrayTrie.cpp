@@ -0,0 +1,382 @@
+#include "DoubleArrayTrie.h"
+#include <queue>
+#include <fstream>
+#include <algorithm>
+
+namespace {
+
+	// identifies the on-disk layout, bump the version when the arrays change
+	const char DOUBLE_ARRAY_MAGIC[8] = { 'C', 'S', 'D', 'A', 'T', 'R', 'I', 'E' };
+	const uint32_t DOUBLE_ARRAY_VERSION = 1;
+
+	// range of sorted words that share the path leading to state
+	struct PendingState {
+		int32_t state;
+		size_t begin;
+		size_t end;
+		size_t depth;
+	};
+
+}
+
+DoubleArrayTrie::DoubleArrayTrie(const std::vector<std::pair<std::string, int>>& sorted_words)
+{
+	// free cells are kept in a doubly linked list in cell order, so looking for a base only visits free cells
+	std::vector<int32_t> next_free;
+	std::vector<int32_t> prev_free;
+	int32_t scan_start = -1; // first free cell worth trying, cells before it are (almost) full
+	int32_t last_free = -1;
+
+	auto grow_cells = [&](size_t size) {
+		size_t old_size = check.size();
+		if (size <= old_size) return;
+		grow(size);
+		next_free.resize(check.size(), -1);
+		prev_free.resize(check.size(), -1);
+		for (size_t cell = std::max<size_t>(old_size, 1); cell < check.size(); ++cell) {
+			int32_t id = static_cast<int32_t>(cell);
+			prev_free[id] = last_free;
+			if (last_free >= 0) next_free[last_free] = id;
+			else scan_start = id;
+			last_free = id;
+		}
+	};
+
+	auto take_cell = [&](int32_t cell) {
+		if (prev_free[cell] >= 0) next_free[prev_free[cell]] = next_free[cell];
+		if (next_free[cell] >= 0) prev_free[next_free[cell]] = prev_free[cell];
+		if (scan_start == cell) scan_start = next_free[cell];
+		if (last_free == cell) last_free = prev_free[cell];
+	};
+
+	grow_cells(sorted_words.empty() ? 1 : 64);
+	check[ROOT] = ROOT;
+
+	std::vector<PendingState> pending;
+	pending.push_back(PendingState{ ROOT, 0, sorted_words.size(), 0 });
+
+	std::vector<int32_t> codes;
+	std::vector<size_t> starts;
+
+	while (!pending.empty()) {
+		PendingState current = pending.back();
+		pending.pop_back();
+
+		size_t i = current.begin;
+
+		// the word spelled exactly by the path sorts first in its range (the last copy wins if it repeats)
+		while (i < current.end && sorted_words[i].first.size() == current.depth) {
+			is_end_of_word[current.state] = 1;
+			frequency[current.state] = sorted_words[i].second;
+			++i;
+		}
+
+		// group the rest of the range by the next letter
+		codes.clear();
+		starts.clear();
+		for (; i < current.end; ++i) {
+			int32_t c = code(sorted_words[i].first[current.depth]);
+			if (codes.empty() || codes.back() != c) {
+				codes.push_back(c);
+				starts.push_back(i);
+			}
+		}
+		if (codes.empty()) continue;
+		starts.push_back(current.end);
+
+		// try the free cells in order as the slot of the first child until every other child slot is free too
+		int32_t candidate = -1;
+		int32_t cell = scan_start;
+		size_t visited = 0;
+		while (true) {
+			if (cell < 0) {
+				// ran out of free cells, append fresh ones
+				size_t old_size = check.size();
+				grow_cells(old_size + 64);
+				cell = static_cast<int32_t>(old_size);
+			}
+			++visited;
+			int32_t base_value = cell - codes[0];
+			if (base_value >= 0) {
+				grow_cells(static_cast<size_t>(base_value) + codes.back() + 1);
+				bool fits = true;
+				for (int32_t c : codes) {
+					if (check[base_value + c] != FREE) {
+						fits = false;
+						break;
+					}
+				}
+				if (fits) {
+					candidate = base_value;
+					break;
+				}
+			}
+			cell = next_free[cell];
+		}
+
+		// when the region scanned was nearly full, stop scanning it for the following states
+		if (visited > 16 && scan_start >= 0 && visited * 20 < static_cast<size_t>(candidate + codes[0] - scan_start)) {
+			scan_start = candidate + codes[0];
+		}
+
+		base[current.state] = candidate;
+		for (size_t g = 0; g < codes.size(); ++g) {
+			int32_t child = candidate + codes[g];
+			take_cell(child);
+			check[child] = current.state;
+			pending.push_back(PendingState{ child, starts[g], starts[g + 1], current.depth + 1 });
+		}
+	}
+
+	// trailing free cells are never reached, drop them
+	size_t used = check.size();
+	while (used > 1 && check[used - 1] == FREE) --used;
+	base.resize(used);
+	check.resize(used);
+	frequency.resize(used);
+	is_end_of_word.resize(used);
+}
+
+bool DoubleArrayTrie::has_valid_links() const
+{
+	// a base below zero could lead the root back to itself
+	if (check[ROOT] != ROOT || base[ROOT] < 0) return false;
+
+	// every used cell must reach the root through its parents, so a corrupt file cannot make dfs loop
+	enum : uint8_t { UNSEEN, WALKING, REACHES_ROOT };
+	std::vector<uint8_t> seen(check.size(), UNSEEN);
+	seen[ROOT] = REACHES_ROOT;
+	std::vector<int32_t> path;
+	for (size_t cell = 1; cell < check.size(); ++cell) {
+		int32_t state = static_cast<int32_t>(cell);
+		if (check[state] == FREE) continue;
+		while (seen[state] == UNSEEN) {
+			int32_t parent = check[state];
+			if (parent < 0 || static_cast<size_t>(parent) >= check.size()) return false;
+			seen[state] = WALKING;
+			path.push_back(state);
+			state = parent;
+		}
+		// walking into a cell of the current path means the parents form a cycle
+		if (seen[state] == WALKING) return false;
+		for (int32_t walked : path) seen[walked] = REACHES_ROOT;
+		path.clear();
+	}
+	return true;
+}
+
+void DoubleArrayTrie::grow(size_t size)
+{
+	if (size <= check.size()) return;
+	size_t capacity = std::max(size, check.size() * 2);
+	base.resize(capacity, 0);
+	check.resize(capacity, -1);
+	frequency.resize(capacity, 0);
+	is_end_of_word.resize(capacity, 0);
+}
+
+int32_t DoubleArrayTrie::find_state(const std::string& word) const
+{
+	if (base.empty()) return -1;
+
+	int32_t state = ROOT;
+	for (char ch : word) {
+		state = transition(state, ch);
+		if (state < 0) return -1;
+	}
+	return state;
+}
+
+bool DoubleArrayTrie::contains(const std::string& word) const
+{
+	int32_t state = find_state(word);
+	return state >= 0 && is_end_of_word[state];
+}
+
+int DoubleArrayTrie::frequency_of(const std::string& word) const
+{
+	int32_t state = find_state(word);
+	return state >= 0 && is_end_of_word[state] ? frequency[state] : 0;
+}
+
+std::vector<std::pair<std::string, int>> DoubleArrayTrie::get_words_with_prefix(const std::string& prefix) const
+{
+	std::vector<std::pair<std::string, int>> results;
+
+	int32_t state = find_state(prefix);
+	if (state < 0) return results;
+
+	std::string current = prefix;
+	dfs(state, current, results);
+
+	return results;
+}
+
+void DoubleArrayTrie::dfs(int32_t state, std::string& current, std::vector<std::pair<std::string, int>>& results) const
+{
+	if (is_end_of_word[state]) {
+		results.emplace_back(current, frequency[state]);
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		int32_t next = transition(state, ch);
+		if (next >= 0) {
+			current.push_back(ch);
+			dfs(next, current, results);
+			current.pop_back();
+		}
+	}
+}
+
+std::vector<std::string> DoubleArrayTrie::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	std::vector<std::pair<std::string, int>> all_words = get_words_with_prefix(prefix);
+
+	auto cmp = [](const auto& a, const auto& b) {
+		// max heap based on frequency
+		return a.second < b.second || (a.second == b.second && a.first > b.first);
+		};
+
+	std::priority_queue <
+		std::pair<std::string, int>,
+		std::vector<std::pair<std::string, int>>,
+		decltype(cmp)
+	> pq(cmp, all_words);
+
+	std::vector<std::string> result;
+	for (int i = 0; i < k && !pq.empty(); i++) {
+		result.push_back(pq.top().first);
+		pq.pop();
+	}
+	return result;
+}
+
+std::vector<FuzzyMatch> DoubleArrayTrie::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+{
+	std::vector<FuzzyMatch> all_matches = get_ranked_fuzzy_matches(input, max_edits);
+
+	std::vector<std::string> words_with_prefix = this->get_top_k_with_prefix(input, k);
+	keep_prefix_matches(all_matches, words_with_prefix, k);
+
+	return all_matches;
+}
+
+std::vector<FuzzyMatch> DoubleArrayTrie::get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha) const
+{
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	if (base.empty()) return {};
+
+	// row[i] = Levenshtein distance between the path spelled so far and input[0, i)
+	std::vector<int> row(input.size() + 1);
+	for (size_t i = 0; i < row.size(); ++i) {
+		row[i] = static_cast<int>(i);
+	}
+
+	std::string current;
+	search_fuzzy(ROOT, input, current, row, max_edits, result_map);
+
+	return rank_fuzzy_matches(result_map, alpha);
+}
+
+void DoubleArrayTrie::search_fuzzy(int32_t state, const std::string& target, std::string& current, const std::vector<int>& row, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	if (is_end_of_word[state] && row.back() <= max_edits) {
+		results[current] = FuzzyMatch{ current, frequency[state], row.back() };
+	}
+
+	std::vector<int> next_row(row.size());
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		int32_t next = transition(state, ch);
+		if (next < 0) continue;
+
+		next_row[0] = row[0] + 1;
+		int row_min = next_row[0];
+		for (size_t i = 1; i < row.size(); ++i) {
+			int substitution = row[i - 1] + (target[i - 1] == ch ? 0 : 1);
+			int insertion = row[i] + 1;
+			int deletion = next_row[i - 1] + 1;
+			next_row[i] = std::min(substitution, std::min(insertion, deletion));
+			row_min = std::min(row_min, next_row[i]);
+		}
+
+		// prune the subtree once no cell of the row is within budget
+		if (row_min <= max_edits) {
+			current.push_back(ch);
+			search_fuzzy(next, target, current, next_row, max_edits, results);
+			current.pop_back();
+		}
+	}
+}
+
+bool DoubleArrayTrie::save_to_file(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) {
+		std::cerr << "Failed to open file for saving.\n";
+		return false;
+	}
+
+	// header followed by the four arrays exactly as they are laid out in memory
+	uint32_t version = DOUBLE_ARRAY_VERSION;
+	uint64_t states = base.size();
+	out.write(DOUBLE_ARRAY_MAGIC, sizeof(DOUBLE_ARRAY_MAGIC));
+	out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	out.write(reinterpret_cast<const char*>(&states), sizeof(states));
+	out.write(reinterpret_cast<const char*>(base.data()), states * sizeof(int32_t));
+	out.write(reinterpret_cast<const char*>(check.data()), states * sizeof(int32_t));
+	out.write(reinterpret_cast<const char*>(frequency.data()), states * sizeof(int32_t));
+	out.write(reinterpret_cast<const char*>(is_end_of_word.data()), states * sizeof(uint8_t));
+
+	return static_cast<bool>(out);
+}
+
+bool DoubleArrayTrie::load_from_file(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) {
+		std::cerr << "No saved data found (" << filename << ").\n";
+		return false;
+	}
+
+	char magic[sizeof(DOUBLE_ARRAY_MAGIC)];
+	uint32_t version = 0;
+	uint64_t states = 0;
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(version));
+	in.read(reinterpret_cast<char*>(&states), sizeof(states));
+	if (!in || !std::equal(magic, magic + sizeof(magic), DOUBLE_ARRAY_MAGIC) || version != DOUBLE_ARRAY_VERSION) {
+		std::cerr << "Not a double-array dictionary (" << filename << ").\n";
+		return false;
+	}
+
+	// the count comes from the file, so size the arrays only once the file is known to hold them
+	const uint64_t state_size = 2 * sizeof(int32_t) + sizeof(int32_t) + sizeof(uint8_t);
+	std::streamoff header_end = in.tellg();
+	in.seekg(0, std::ios::end);
+	std::streamoff file_end = in.tellg();
+	in.seekg(header_end);
+	bool sized = in && states > 0 && states <= static_cast<uint64_t>(INT32_MAX)
+		&& static_cast<uint64_t>(file_end - header_end) == states * state_size;
+
+	if (sized) {
+		base.resize(states);
+		check.resize(states);
+		frequency.resize(states);
+		is_end_of_word.resize(states);
+		in.read(reinterpret_cast<char*>(base.data()), states * sizeof(int32_t));
+		in.read(reinterpret_cast<char*>(check.data()), states * sizeof(int32_t));
+		in.read(reinterpret_cast<char*>(frequency.data()), states * sizeof(int32_t));
+		in.read(reinterpret_cast<char*>(is_end_of_word.data()), states * sizeof(uint8_t));
+	}
+
+	if (!sized || !in || !has_valid_links()) {
+		std::cerr << "Truncated double-array dictionary (" << filename << ").\n";
+		base.clear();
+		check.clear();
+		frequency.clear();
+		is_end_of_word.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "FuzzyMatch.h"
+
+
+// Read-only double-array (BASE/CHECK) compilation of a Trie for serving between dictionary reloads.
+// Every state is an index into flat arrays, and the transition from state s on letter c is
+//     t = base[s] + code(c), valid when check[t] == s
+// so a lookup step is a single array index instead of following a child pointer.
+// Frequencies and end-of-word flags sit in parallel arrays indexed by state, which also makes the
+// whole structure a handful of contiguous blocks that can be written to and read from disk as-is.
+class DoubleArrayTrie {
+
+public:
+
+	DoubleArrayTrie() = default;
+
+	// words must be sorted and unique, which is what Trie::get_all_words produces
+	explicit DoubleArrayTrie(const std::vector<std::pair<std::string, int>>& sorted_words);
+
+	bool contains(const std::string& word) const;
+	int frequency_of(const std::string& word) const; // 0 when the word is not in the dictionary
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	size_t state_count() const { return base.size(); }
+	size_t memory_usage() const { return base.size() * (2 * sizeof(int32_t) + sizeof(int32_t) + sizeof(uint8_t)); }
+
+	bool save_to_file(const std::string& filename) const;
+	bool load_from_file(const std::string& filename);
+
+private:
+
+	static constexpr int32_t FREE = -1; // check value of an unused cell
+	static constexpr int ROOT = 0;
+
+	std::vector<int32_t> base;
+	std::vector<int32_t> check;
+	std::vector<int32_t> frequency;
+	std::vector<uint8_t> is_end_of_word;
+
+	static int32_t code(char ch) { return ch - 'a' + 1; } // 1..26, 0 is never a valid transition
+
+	int32_t transition(int32_t state, char ch) const {
+		if (ch < 'a' || ch > 'z') return -1;
+		size_t next = static_cast<size_t>(base[state]) + code(ch);
+		return next < check.size() && check[next] == state ? static_cast<int32_t>(next) : -1;
+	}
+
+	int32_t find_state(const std::string& word) const;
+	void grow(size_t size);
+
+	std::vector<std::pair<std::string, int>> get_words_with_prefix(const std::string& prefix) const;
+	bool has_valid_links() const; // check[] only links used states to in-range parents, without cycles
+	void dfs(int32_t state, std::string& current, std::vector<std::pair<std::string, int>>& results) const;
+
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
+	void search_fuzzy(int32_t state, const std::string& target, std::string& current, const std::vector<int>& row, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+};
@@ -0,0 +1,580 @@
+#include "EditorCore.h"
+#include <fstream>
+#include <chrono>
+#include <regex> // For std::regex_search
+
+void EditorCore::open_dictionary(bool read_only)
+{
+    // mapping the binary dictionary takes the same time for any dictionary size,
+    // the text file is only parsed when there is no binary one yet
+    if (this->mapped_dictionary.open(BINARY_DICTIONARY_FILE, true)) {
+        this->dictionary_generation = this->mapped_dictionary.get_generation();
+    }
+    else {
+        if (std::ifstream(BINARY_DICTIONARY_FILE)) {
+            // there is a binary dictionary, just not one that can be read: it and the log may hold selections
+            // the text dictionary does not, so writing either of them now could lose those for good
+            std::cerr << "The binary dictionary could not be opened, nothing is saved this session.\n";
+            read_only = true;
+        }
+        this->trie.load_from_file_parallel(DICTIONARY_FILE);
+    }
+
+    // replay the selections made since the dictionary was last written, then keep appending to the log
+    auto apply = [this](const std::string& word, int delta) {
+        this->apply_frequency_update(word, delta);
+    };
+    if (read_only) {
+        this->update_log.replay(UPDATE_LOG_FILE, this->dictionary_generation, apply);
+    }
+    else if (!this->update_log.open(UPDATE_LOG_FILE, this->dictionary_generation, apply)) {
+        std::cerr << "Selections cannot be logged, nothing is saved this session.\n";
+        read_only = true;
+    }
+    this->persist_selections = !read_only;
+}
+
+bool EditorCore::close_dictionary()
+{
+    if (mapped_dictionary.is_open() || !persist_selections) {
+        // every selection is already in the log, the dictionary is only rewritten once the log grows large;
+        // a read-only dictionary is never written
+        update_log.close();
+        return false;
+    }
+
+    // started from the text dictionary: write the binary one the next start maps
+    compact_dictionary();
+    update_log.close();
+    return true;
+}
+
+void EditorCore::apply_frequency_update(const std::string& word, int delta)
+{
+    if (mapped_dictionary.is_open()) {
+        mapped_dictionary.add_frequency(word, delta);
+    }
+    else {
+        trie.add_frequency(word, delta);
+    }
+}
+
+void EditorCore::learn_selection(const std::string& word)
+{
+    apply_frequency_update(word, Trie::SELECTION_BONUS);
+    if (!persist_selections) {
+        return; // a replay learns like the session it replays, but leaves the dictionary files alone
+    }
+    update_log.append(word, Trie::SELECTION_BONUS);
+
+    if (update_log.record_count() >= COMPACT_AFTER_RECORDS) {
+        compact_dictionary();
+    }
+}
+
+void EditorCore::compact_dictionary()
+{
+    // the new image goes out first with the next generation, then the log restarts for it;
+    // a crash in between leaves a log for an older generation, which the next start discards
+    uint32_t next_generation = dictionary_generation + 1;
+
+    if (mapped_dictionary.is_open()) {
+        if (!mapped_dictionary.rewrite(next_generation)) return;
+    }
+    else {
+        trie.save_to_file(DICTIONARY_FILE);
+        trie.save_to_file(BINARY_DICTIONARY_FILE, DictionaryFormat::BINARY, next_generation);
+    }
+
+    dictionary_generation = next_generation;
+    update_log.reset(next_generation);
+}
+
+bool EditorCore::replay_trace(const std::string& trace_file, const std::string& latency_file)
+{
+    std::ifstream in(trace_file);
+    if (!in) {
+        std::cerr << "No keystroke trace found (" << trace_file << ").\n";
+        return false;
+    }
+
+    std::vector<std::pair<long long, int>> keys; // (microseconds since recording started, key)
+    long long elapsed;
+    int ch;
+    while (in >> elapsed >> ch) {
+        keys.emplace_back(elapsed, ch);
+    }
+
+    // the keys are handled back to back, as fast as the editor can take them; the recorded times only tell
+    // how long the session took to type
+    struct KeyLatency {
+        int key;
+        double total;      // the whole key handling
+        double suggestion; // suggestion lookup, TAB only
+        double render;     // tokenizing and rendering the line
+    };
+    std::vector<KeyLatency> latencies;
+    latencies.reserve(keys.size());
+
+    bool persisted = persist_selections;
+    persist_selections = false;
+    redraw(); // the initial prompt, as a session starts with it
+    for (const auto& key : keys) {
+        suggestion_micros = 0;
+        render_micros = 0;
+        auto key_start = std::chrono::steady_clock::now();
+        bool go_on = handle_key(key.second);
+        double total = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - key_start).count();
+        latencies.push_back({ key.second, total, suggestion_micros, render_micros });
+        if (!go_on) {
+            break;
+        }
+    }
+    persist_selections = persisted;
+
+    if (!latency_file.empty()) {
+        std::ofstream out(latency_file, std::ios::trunc);
+        out << "key total_us suggestion_us render_us\n";
+        for (const KeyLatency& latency : latencies) {
+            out << latency.key << ' ' << latency.total << ' ' << latency.suggestion << ' ' << latency.render << '\n';
+        }
+        if (!out) {
+            std::cerr << "Could not write the latencies (" << latency_file << ").\n";
+        }
+    }
+
+    // p50, p90, p99 and max of one column, over every key or the TAB presses only
+    auto print_row = [&latencies](const char* name, bool tab_only, double KeyLatency::* column) {
+        std::vector<double> values;
+        for (const KeyLatency& latency : latencies) {
+            if (!tab_only || latency.key == KEY_TAB) values.push_back(latency.*column);
+        }
+        std::cout << "  " << name;
+        if (values.empty()) {
+            std::cout << "  -\n";
+            return;
+        }
+        std::sort(values.begin(), values.end());
+        for (double p : { 0.5, 0.9, 0.99 }) {
+            std::cout << "  " << values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+        }
+        std::cout << "  " << values.back() << "\n";
+    };
+
+    double typing_seconds = keys.empty() ? 0 : keys.back().first / 1e6;
+    std::cout << "Replayed " << latencies.size() << " keystrokes from " << trace_file << " (typed in " << typing_seconds << " s).\n";
+    std::cout << "Latency in microseconds: p50, p90, p99, max\n";
+    print_row("keystroke      ", false, &KeyLatency::total);
+    print_row("render         ", false, &KeyLatency::render);
+    print_row("TAB keystroke  ", true, &KeyLatency::total);
+    print_row("TAB suggestions", true, &KeyLatency::suggestion);
+    return true;
+}
+
+bool EditorCore::handle_key(int ch)
+{
+    // Handle special keys
+    if (ch == KEY_ESC) {
+        output->end_session();
+        return false;
+    }
+    else if (ch == KEY_ENTER) {
+        // First, process the current line's content for potential indent changes
+        if (!complete_input_buffer.empty()) {
+            std::string trimmed_buffer = complete_input_buffer;
+            // Remove trailing whitespace for better matching
+            trimmed_buffer.erase(trimmed_buffer.find_last_not_of(" \t\n\r") + 1);
+
+            // Simple brace-based indent increment
+            if (trimmed_buffer.back() == '{') {
+                current_indent_level++;
+            }
+            // Heuristic for loop/conditional start (e.g., "for (int i = 0;" or "if (condition)")
+            else if (std::regex_search(trimmed_buffer, std::regex(R"((for|while|if|switch)\s*\(.*)", std::regex_constants::icase))) {
+                current_indent_level++;
+            }
+        }
+
+        output->new_line(); // Move to next line
+
+        // Clear buffers for the new line
+        complete_input_buffer.clear();
+        current_word_buffer.clear();
+
+        redraw_input_line(""); // Redraw the new empty prompt with new indentation
+    }
+    else if (ch == KEY_BACKSPACE) {
+        if (!complete_input_buffer.empty()) {
+            char last_char = complete_input_buffer.back();
+            complete_input_buffer.pop_back();
+
+            // If we backspace a brace, adjust indent level
+            if (last_char == '{' && current_indent_level > 0) {
+                current_indent_level--;
+            }
+            else if (last_char == '}' && current_indent_level > 0) { // If backspacing a '}' from its dedented position
+                // This logic is for visual consistency if '}' caused a dedent but was then backspaced
+                // It can be complex; a simpler heuristic: if the char before '}' was a space/tab
+                // that was part of the original indent, then it might be valid to re-increment.
+                // For now, if we backspace a closing brace, and the current line would naturally be at a higher indent
+                // due to previous actions (e.g., typing `{` on prior line, pressing enter, then typing `}` immediately)
+                // then we might need to re-increment. This is context-dependent.
+                // For simplicity, for now, we only decrement on '{' backspace.
+                // A more robust solution would be to look at the line content before backspace.
+            }
+
+            // Handle backspacing into an auto-closed character pair
+            if (complete_input_buffer.length() >= current_word_buffer.length() + 1) { // Check if there's enough room to pop a char
+                char char_before_last = complete_input_buffer.back();
+                if ((last_char == ')' && char_before_last == '(') ||
+                    (last_char == '}' && char_before_last == '{') ||
+                    (last_char == ']' && char_before_last == '[') ||
+                    (last_char == '"' && char_before_last == '"'))
+                {
+                    complete_input_buffer.pop_back(); // Pop the opening character too
+                }
+            }
+
+            if (!current_word_buffer.empty()) {
+                current_word_buffer.pop_back();
+            }
+            redraw_input_line(complete_input_buffer);
+        }
+        else {
+            redraw_input_line(complete_input_buffer); // Ensure cursor is correct even if empty
+        }
+    }
+    else if (ch == KEY_SPACE) {
+        complete_input_buffer.push_back(static_cast<char>(ch));
+        current_word_buffer.clear(); // A space always starts a new word for autocomplete purposes
+        redraw_input_line(complete_input_buffer);
+    }
+    else if (ch == KEY_TAB) {
+        // Attempt autocomplete for current_word_buffer
+        auto lookup_start = std::chrono::steady_clock::now();
+        std::string suggested_word = this->show_suggestions(current_word_buffer);
+        suggestion_micros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - lookup_start).count();
+        if (!suggested_word.empty()) {
+            std::string suffix = string_handler.getSuffixDifference(current_word_buffer, suggested_word);
+            complete_input_buffer.append(suffix);
+            current_word_buffer = suggested_word; // Update current_word_buffer to full suggestion
+            this->learn_selection(suggested_word); // accepted suggestion, ranks higher next time
+            redraw_input_line(complete_input_buffer);
+        }
+        else {
+            // If no suggestion, insert actual tab spaces (as defined by INDENT_SPACES)
+            for (int i = 0; i < INDENT_SPACES; ++i) {
+                complete_input_buffer.push_back(' ');
+            }
+            current_word_buffer.clear(); // Tab can also signify end of current word for autocomplete context
+            redraw_input_line(complete_input_buffer);
+        }
+    }
+    else if (ch == 0 || ch == 224) {
+        // Extended keys (e.g., arrow keys), the front-end has consumed their second byte
+        redraw_input_line(complete_input_buffer); // Redraw just in case, no change to buffer
+    }
+    else {
+        // Regular character input
+        char char_typed = static_cast<char>(ch);
+        complete_input_buffer.push_back(char_typed); // Push the character first
+
+        // Adjust indent if a '}' is typed, and it's the first non-whitespace character on the line
+        if (char_typed == '}') {
+            std::string current_line_content_no_prompt_or_indent = complete_input_buffer;
+            // Remove leading whitespace (which would be from the indent)
+            size_t first_non_ws = current_line_content_no_prompt_or_indent.find_first_not_of(" \t");
+            if (first_non_ws != std::string::npos) {
+                current_line_content_no_prompt_or_indent = current_line_content_no_prompt_or_indent.substr(first_non_ws);
+            }
+            else {
+                current_line_content_no_prompt_or_indent = ""; // Line is all whitespace
+            }
+
+            // If after removing initial whitespace, '}' is the first character, then dedent
+            if (!current_line_content_no_prompt_or_indent.empty() && current_line_content_no_prompt_or_indent[0] == '}') {
+                if (current_indent_level > 0) {
+                    current_indent_level--; // Dedent for closing brace
+                }
+            }
+        }
+        bool auto_closed = false;
+        /*
+        // Auto-closing Braces/Quotes
+        
+        if (char_typed == '(') {
+            complete_input_buffer.push_back(')');
+            auto_closed = true;
+        }
+        else if (char_typed == '{') {
+            complete_input_buffer.push_back('}');
+            auto_closed = true;
+        }
+        else if (char_typed == '[') {
+            complete_input_buffer.push_back(']');
+            auto_closed = true;
+        }
+        */
+        if (char_typed == '"') {
+            // Only auto-close if it's not closing an existing quote.
+            // This is a simple heuristic: count quotes in the current line.
+            // If it's odd, it means we just typed an opening quote.
+            if (std::count(complete_input_buffer.begin(), complete_input_buffer.end(), '"') % 2 != 0) {
+                complete_input_buffer.push_back('"');
+                auto_closed = true;
+            }
+        }
+        else if (char_typed == '\'') {
+            // Single quotes: similar logic to double quotes
+            if (std::count(complete_input_buffer.begin(), complete_input_buffer.end(), '\'') % 2 != 0) {
+                complete_input_buffer.push_back('\'');
+                auto_closed = true;
+            }
+        }
+
+        current_word_buffer.push_back(char_typed); // Push the actual character typed into current_word_buffer
+
+        // Redraw to show the new characters; if auto-closed, the cursor stays before the closing character
+        redraw_input_line(complete_input_buffer, auto_closed ? 1 : 0);
+    }
+    return true;
+} // End of handle_key()
+
+void EditorCore::initialize_keywords()
+{
+    keywords = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto",
+    "bool", "break",
+    "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "concept", "const", "consteval", "constexpr", "const_cast", "continue", "co_await", "co_returns", "co_yield",
+    "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern",
+    "false", "float", "for", "friend",
+    "goto",
+    "if", "inline", "int",
+    "long",
+    "mutable",
+    "namespace", "new", "noexcept", "nullptr",
+    "operator", "or", "or_eq",
+    "private", "protected", "public",
+    "reflexpr", "register", "reinterpret_cast", "requires", "return",
+    "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "switch", "synchronized",
+    "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using",
+    "virtual", "void", "volatile",
+    "wchar_t", "while",
+    "xor", "xor_eq"
+    };
+    // Add common preprocessor directives, though they are usually handled by a preprocessor phase
+    // You could also parse them as a special type if needed.
+    // For now, we'll include common ones in the keywords set if we want to highlight them.
+    keywords.insert("#include");
+    keywords.insert("#define");
+    keywords.insert("#ifdef");
+    keywords.insert("#ifndef");
+    keywords.insert("#endif");
+    keywords.insert("#pragma");
+}
+
+std::vector<Token> EditorCore::tokenize(const std::string& line) const
+{
+    std::vector<Token> tokens;
+    size_t current_pos = 0;
+    size_t line_length = line.length();
+
+    while (current_pos < line_length) {
+        char c = line[current_pos];
+
+        // 1. Handle Whitespace
+        if (isspace(c)) {
+            size_t start = current_pos;
+            while (current_pos < line_length && isspace(line[current_pos])) {
+                current_pos++;
+            }
+            tokens.push_back({ line.substr(start, current_pos - start), TokenTYPE::DEFAULT, start, current_pos - start });
+            continue;
+        }
+
+        // 2. Handle Comments
+        if (c == '/') {
+            if (current_pos + 1 < line_length) {
+                // Single-line comment //
+                if (line[current_pos + 1] == '/') {
+                    size_t start = current_pos;
+                    while (current_pos < line_length && line[current_pos] != '\n' && line[current_pos] != '\r') {
+                        current_pos++;
+                    }
+                    tokens.push_back({ line.substr(start, current_pos - start), TokenTYPE::COMMENT, start, current_pos - start });
+                    continue; // Continue from current_pos (which is now at or past the newline)
+                }
+                // Multi-line comment /* */
+                else if (line[current_pos + 1] == '*') {
+                    size_t start = current_pos;
+                    current_pos += 2; // Move past /*
+                    while (current_pos + 1 < line_length && !(line[current_pos] == '*' && line[current_pos + 1] == '/')) {
+                        current_pos++;
+                    }
+                    if (current_pos + 1 < line_length) { // Found closing */
+                        current_pos += 2; // Move past */
+                    }
+                    else {
+                        // Unclosed multi-line comment, consume till end of line
+                        current_pos = line_length;
+                    }
+                    tokens.push_back({ line.substr(start, current_pos - start), TokenTYPE::COMMENT, start, current_pos - start });
+                    continue;
+                }
+            }
+        }
+
+        // 3. Handle String Literals
+        if (c == '"' || c == '\'') {
+            char quote_char = c;
+            size_t start = current_pos;
+            current_pos++; // Move past opening quote
+
+            while (current_pos < line_length && line[current_pos] != quote_char) {
+                // Handle escaped quotes within string literals
+                if (line[current_pos] == '\\' && current_pos + 1 < line_length) {
+                    current_pos++; // Skip the escaped character
+                }
+                current_pos++;
+            }
+
+            if (current_pos < line_length) { // Found closing quote
+                current_pos++; // Move past closing quote
+            }
+            else {
+                // Unclosed string literal, consume till end of line
+                current_pos = line_length;
+            }
+            tokens.push_back({ line.substr(start, current_pos - start), TokenTYPE::STRING_LITERAL, start, current_pos - start });
+            continue;
+        }
+
+        // 4. Handle Identifiers and Keywords (unchanged from previous step)
+        if (isalpha(c) || c == '_') {
+            size_t start = current_pos;
+            while (current_pos < line_length && (isalnum(line[current_pos]) || line[current_pos] == '_')) {
+                current_pos++;
+            }
+            std::string word = line.substr(start, current_pos - start);
+            if (keywords.count(word)) {
+                // Check for preprocessor directives (start with '#')
+                if (!word.empty() && word[0] == '#') {
+                    tokens.push_back({ word, TokenTYPE::PREPROCESSOR, start, word.length() });
+                }
+                else {
+                    tokens.push_back({ word, TokenTYPE::KEYWORD, start, word.length() });
+                }
+            }
+            else {
+                tokens.push_back({ word, TokenTYPE::DEFAULT, start, word.length() }); // Using DEFAULT for general identifiers
+            }
+            continue;
+        }
+
+        // 5. Handle Numbers (unchanged from previous step)
+        if (isdigit(c)) {
+            size_t start = current_pos;
+            while (current_pos < line_length && isdigit(line[current_pos])) {
+                current_pos++;
+            }
+            tokens.push_back({ line.substr(start, current_pos - start), TokenTYPE::NUMBER_LITERAL, start, current_pos - start });
+            continue;
+        }
+
+        // 6. Handle Multi-character Operators (Add these first, before single-char ops)
+        // Add more multi-character operators here as needed
+        if (current_pos + 1 < line_length) {
+            std::string two_char_op = line.substr(current_pos, 2);
+            if (two_char_op == "==" || two_char_op == "!=" || two_char_op == "<=" ||
+                two_char_op == ">=" || two_char_op == "&&" || two_char_op == "||" ||
+                two_char_op == "++" || two_char_op == "--" || two_char_op == "->" ||
+                two_char_op == "::" || two_char_op == "+=" || two_char_op == "-=" ||
+                two_char_op == "*=" || two_char_op == "/=" || two_char_op == "%=" ||
+                two_char_op == "&=" || two_char_op == "|=" || two_char_op == "^=" ||
+                two_char_op == "<<" || two_char_op == ">>") {
+                tokens.push_back({ two_char_op, TokenTYPE::OPERATOR, current_pos, 2 });
+                current_pos += 2;
+                continue;
+            }
+            // Add three-character operators here if any (e.g., "...")
+        }
+
+
+        // 7. Handle Single-character Operators and Punctuation (expanded list)
+        if (std::string("+-*/%&|^~!=<>(){}[];:,.").find(c) != std::string::npos) {
+            tokens.push_back({ std::string(1, c), TokenTYPE::PUNCTUATION, current_pos, 1 }); // Using PUNCTUATION for these
+            current_pos++;
+            continue;
+        }
+
+        // If no rule matches, just treat as default and advance (should be rare for C++)
+        tokens.push_back({ std::string(1, c), TokenTYPE::DEFAULT, current_pos, 1 });
+        current_pos++;
+    }
+    return tokens;
+}
+
+void EditorCore::redraw_input_line(const std::string& current_display_buffer, size_t cursor_from_end)
+{
+    auto render_start = std::chrono::steady_clock::now();
+    output->draw_line(current_indent_level * INDENT_SPACES, tokenize(current_display_buffer), cursor_from_end);
+    render_micros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - render_start).count();
+}
+
+std::string EditorCore::show_suggestions(const std::string& input)
+{
+    std::vector<FuzzyMatch> matches;
+    std::vector<std::string> words_with_prefix;
+
+    uint64_t version = mapped_dictionary.is_open() ? mapped_dictionary.version(input) : trie.version(input);
+    const std::vector<FuzzyMatch>* cached_matches = query_cache.find_fuzzy(input, MAX_EDITS, TOP_K, version);
+    const std::vector<std::string>* cached_words = query_cache.find_prefix(input, TOP_K, version);
+
+    if (cached_matches && cached_words) {
+        matches = *cached_matches;
+        words_with_prefix = *cached_words;
+    }
+    else {
+        if (mapped_dictionary.is_open()) {
+            matches = mapped_dictionary.get_top_k_fuzzy_matches(input, MAX_EDITS, TOP_K);
+            words_with_prefix = mapped_dictionary.get_top_k_with_prefix(input, TOP_K);
+        }
+        else {
+            completion_session.set_word(input);
+            matches = completion_session.get_top_k_fuzzy_matches();
+            words_with_prefix = completion_session.get_top_k_with_prefix();
+        }
+        query_cache.store_fuzzy(input, MAX_EDITS, TOP_K, version, matches);
+        query_cache.store_prefix(input, TOP_K, version, words_with_prefix);
+    }
+
+    std::unordered_set<std::string> prefix_words_set(words_with_prefix.begin(), words_with_prefix.end());
+
+    this->prefix_checking(matches, prefix_words_set);
+
+    if (matches.empty()) {
+        return ""; // No suggestions found, return empty string without printing anything.
+    }
+
+    return matches[0].word;
+}
+
+void EditorCore::prefix_checking(std::vector<FuzzyMatch>& matches, std::unordered_set<std::string>& prefix_words_set)
+{
+    for (size_t i = 0; i < matches.size(); /* no i++ here */) {
+        bool found_in_prefix = false;
+        if (prefix_words_set.count(matches[i].word)) {
+            found_in_prefix = true;
+            matches[i].score = matches[i].score + 200; // Boost score for prefix matches
+        }
+        if (!found_in_prefix) {
+            matches.erase(matches.begin() + i);
+        }
+        else {
+            i++;
+        }
+    }
+}
\ No newline at end of file
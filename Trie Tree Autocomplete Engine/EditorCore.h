@@ -0,0 +1,122 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm> // For std::count
+#include <unordered_set>
+#include "Trie.h"
+#include "MappedDictionary.h"
+#include "UpdateLog.h"
+#include "CompletionSession.h"
+#include "QueryCache.h"
+#include "StringHandler.h"
+#include "EditorOutput.h"
+
+// ASCII values for special keys
+#define KEY_SPACE 32
+#define KEY_TAB   9
+#define KEY_ENTER 13 // ASCII for Carriage Return (Enter key for _getch())
+#define KEY_ESC   27 // Escape key to exit the loop
+#define KEY_BACKSPACE 8 // ASCII for Backspace - NOW DEFINED
+
+const std::string DICTIONARY_FILE = "dictionary.txt";
+const std::string BINARY_DICTIONARY_FILE = "dictionary.bin"; // written on exit, mapped on start when present
+const std::string UPDATE_LOG_FILE = "dictionary.log";         // selections since the binary dictionary was written
+const size_t COMPACT_AFTER_RECORDS = 1000;                    // fold the log into the binary dictionary past this size
+const int MAX_EDITS = 5;
+const int TOP_K = 1; // previously 30
+const double ALPHA = 1.0;
+
+// The editor without its screen: the line and word being typed, indentation, tokenizing, suggestions and the
+// dictionary they come from. Keys go in through handle_key, and everything to show goes out through an
+// EditorOutput, so the core builds and runs on any platform. MainLogicController puts it behind the Windows console.
+class EditorCore {
+
+public:
+
+	explicit EditorCore(EditorOutput& output) : output(&output) { initialize_keywords(); }
+
+	// maps the binary dictionary, or parses the text one when there is none, and replays the update log.
+	// read_only leaves every file as it was, for replaying a trace: the update log is applied but never created,
+	// repaired or appended to, and selections are learned in memory only. The dictionary is also opened read_only
+	// when the binary one exists but cannot be mapped, or when the update log cannot be opened for appending
+	void open_dictionary(bool read_only = false);
+
+	// closes the update log; a dictionary that was parsed from text is written out first, in both formats.
+	// true when the dictionary files were rewritten
+	bool close_dictionary();
+
+	// later keys are shown on output, which must outlive its use
+	void set_output(EditorOutput& new_output) { output = &new_output; }
+
+	// one key, as _getch returns it (the second byte of an extended key left out); false when it ends the
+	// session (ESC)
+	bool handle_key(int ch);
+
+	// draws the current line, the first line needs one before any key
+	void redraw() { redraw_input_line(complete_input_buffer); }
+
+	// feeds a recorded trace ("microseconds key" lines) through handle_key as fast as it goes, then prints the
+	// latency percentiles of a keystroke, of its rendering and of the suggestion lookups, and writes every key's
+	// latencies to latency_file when one is given. Selections are learned in memory only; open the dictionary
+	// read_only as well, so the files are left exactly as they were.
+	bool replay_trace(const std::string& trace_file, const std::string& latency_file = "");
+
+	const std::string& get_line() const { return complete_input_buffer; }
+	const std::string& get_word() const { return current_word_buffer; }
+	int get_indent_level() const { return current_indent_level; }
+
+	// time the last key spent looking up suggestions and tokenizing and drawing the line
+	double get_suggestion_micros() const { return suggestion_micros; }
+	double get_render_micros() const { return render_micros; }
+
+	// The tokenizer function: takes a line of code and breaks it into tokens
+	std::vector<Token> tokenize(const std::string& line) const;
+
+private:
+
+	EditorOutput* output;
+	StringHandler string_handler;
+
+	std::string complete_input_buffer; // Stores the entire line typed by the user
+	std::string current_word_buffer;   // Stores the current word being typed (clears on space)
+
+	Trie trie;
+
+	// when the binary dictionary could be mapped, suggestions are served from it and trie stays empty
+	MappedDictionary mapped_dictionary;
+
+	// the word being completed on the trie, kept between TAB presses so a longer word starts from the shorter one
+	CompletionSession completion_session{ trie, MAX_EDITS, TOP_K };
+
+	// the same prefixes are completed over and over; results stay valid until their subtree changes
+	QueryCache query_cache;
+
+	// learned selections are appended here as they happen instead of rewriting the dictionary
+	UpdateLog update_log;
+	uint32_t dictionary_generation = 0; // generation of the binary dictionary the log applies to, 0 for the text one
+
+	// cleared for a read-only dictionary and while a trace is replayed: selections are still learned, but not
+	// written to the log
+	bool persist_selections = true;
+
+	double suggestion_micros = 0;
+	double render_micros = 0;
+
+	void apply_frequency_update(const std::string& word, int delta);
+	void learn_selection(const std::string& word);
+	void compact_dictionary();
+	int current_indent_level = 0; // New member variable for indentation
+	const int INDENT_SPACES = 4; // Define indentation size (e.g., 4 spaces)
+
+	// Method to initialize the set of C++ keywords
+	void initialize_keywords();
+	// Set of C++ keywords for quick lookup during tokenization
+	std::unordered_set<std::string> keywords;
+
+	// cursor_from_end: where the cursor stays, counted back from the end of the line
+	void redraw_input_line(const std::string& current_display_buffer, size_t cursor_from_end = 0);
+
+	std::string show_suggestions(const std::string& input);
+	void prefix_checking(std::vector<FuzzyMatch>& matches, std::unordered_set<std::string>& prefix_words_set);
+};
@@ -0,0 +1,21 @@
+#include "EditorOutput.h"
+
+void MemoryOutput::draw_line(int indent_columns, const std::vector<Token>& tokens, size_t cursor_from_end)
+{
+	line.assign(indent_columns, ' ');
+	types.assign(line.size(), TokenTYPE::DEFAULT);
+
+	for (const Token& token : tokens) {
+		line += token.text;
+		types.insert(types.end(), token.text.size(), token.type);
+	}
+	cursor = line.size() - cursor_from_end;
+}
+
+void MemoryOutput::new_line()
+{
+	lines.push_back(line);
+	line.clear();
+	types.clear();
+	cursor = 0;
+}
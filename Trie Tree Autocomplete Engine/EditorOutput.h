@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+
+enum class TokenTYPE {
+	DEFAULT,
+	KEYWORD,
+	STRING_LITERAL,
+	NUMBER_LITERAL,
+	COMMENT,
+	OPERATOR,
+	PUNCTUATION, // For braces, parentheses, semicolons etc.
+	PREPROCESSOR // For #include, #define etc.
+};
+
+struct Token {
+	std::string text;
+	TokenTYPE type;
+	size_t start_pos; // Starting position of the token in the original string
+	size_t length;    // Length of the token
+};
+
+// Where EditorCore shows the line being edited. The core never draws anything itself, so it runs the same behind
+// the Windows console (ConsoleOutput), behind another front-end, or with no screen at all.
+class EditorOutput {
+
+public:
+
+	virtual ~EditorOutput() = default;
+
+	// the whole input line again: indent_columns of indentation, then the tokens in order,
+	// with the cursor cursor_from_end characters before the end of the line
+	virtual void draw_line(int indent_columns, const std::vector<Token>& tokens, size_t cursor_from_end) = 0;
+
+	// the current line is finished, the next one starts below it
+	virtual void new_line() = 0;
+
+	// the session ended (ESC)
+	virtual void end_session() = 0;
+};
+
+// draws nothing, so timing the editor measures the editor alone
+class NullOutput : public EditorOutput {
+
+public:
+
+	void draw_line(int, const std::vector<Token>&, size_t) override {}
+	void new_line() override {}
+	void end_session() override {}
+};
+
+// keeps what a screen would show, every finished line and the current one with the token type of each character
+class MemoryOutput : public EditorOutput {
+
+public:
+
+	void draw_line(int indent_columns, const std::vector<Token>& tokens, size_t cursor_from_end) override;
+	void new_line() override;
+	void end_session() override { ended = true; }
+
+	const std::vector<std::string>& get_lines() const { return lines; }
+	const std::string& get_line() const { return line; }
+	const std::vector<TokenTYPE>& get_types() const { return types; }
+	size_t get_cursor() const { return cursor; }
+	bool has_ended() const { return ended; }
+
+private:
+
+	std::vector<std::string> lines;
+	std::string line;
+	std::vector<TokenTYPE> types; // one per character of line, indentation included
+	size_t cursor = 0;            // position in line
+	bool ended = false;
+};
@@ -0,0 +1,58 @@
+#include "EpochReclaimer.h"
+#include <thread>
+#include <functional>
+
+const size_t EpochReclaimer::SLOTS;
+
+EpochReclaimer::~EpochReclaimer()
+{
+	for (const Retired& entry : retired) {
+		entry.destroy(entry.object);
+	}
+}
+
+size_t EpochReclaimer::pin()
+{
+	// start at a slot picked by the thread id, so a thread usually finds the same free slot right away
+	size_t slot = std::hash<std::thread::id>()(std::this_thread::get_id()) % SLOTS;
+	while (true) {
+		uint64_t expected = 0;
+		// sequentially consistent: the pin must be visible to the writer before this reader loads any pointer,
+		// an epoch that is stale by the time the slot is taken only holds reclamation back, it is never unsafe
+		uint64_t pinned = (epoch.load() << 1) | 1;
+		if (slots[slot].state.compare_exchange_strong(expected, pinned)) return slot;
+		slot = (slot + 1) % SLOTS;
+	}
+}
+
+void EpochReclaimer::retire(void* object, void (*destroy)(void*))
+{
+	retired.push_back(Retired{ epoch.load(), object, destroy });
+}
+
+size_t EpochReclaimer::collect()
+{
+	uint64_t current = epoch.load();
+
+	bool everyone_current = true;
+	for (const Slot& slot : slots) {
+		uint64_t state = slot.state.load();
+		if ((state & 1) && (state >> 1) != current) {
+			everyone_current = false;
+			break;
+		}
+	}
+	if (everyone_current) {
+		epoch.store(++current);
+	}
+
+	// retired in epoch e means unlinked while readers of e - 1 or e could still be pinned,
+	// both are gone once the epoch reached e + 2
+	size_t freed = 0;
+	while (!retired.empty() && retired.front().epoch + 2 <= current) {
+		retired.front().destroy(retired.front().object);
+		retired.pop_front();
+		++freed;
+	}
+	return freed;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+
+
+// Epoch-based reclamation for structures that readers traverse without taking a lock.
+// A reader pins the current epoch for the duration of one read (Guard). The writer first unlinks an object,
+// so no new reader can reach it, then retires it; the object is freed once the global epoch has advanced twice
+// past the epoch it was retired in. The epoch only advances when every pinned reader has seen the current one,
+// so by then every reader that could still hold the object has finished.
+// Readers never wait for the writer and only write to their own slot; retire and collect belong to the writer
+// and must not be called from several threads at once.
+class EpochReclaimer {
+
+public:
+
+	static const size_t SLOTS = 64; // readers pinned at the same time, a reader finding them all taken spins
+
+	// pins the current epoch for as long as it lives
+	class Guard {
+
+	public:
+
+		explicit Guard(EpochReclaimer& reclaimer) : reclaimer(reclaimer), slot(reclaimer.pin()) {}
+		~Guard() { reclaimer.unpin(slot); }
+
+		Guard(const Guard&) = delete;
+		Guard& operator=(const Guard&) = delete;
+
+	private:
+
+		EpochReclaimer& reclaimer;
+		size_t slot;
+	};
+
+	EpochReclaimer() = default;
+	~EpochReclaimer(); // frees everything still retired, no reader may be pinned any more
+
+	EpochReclaimer(const EpochReclaimer&) = delete;
+	EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+	// hands an unlinked object over, destroy(object) runs once no reader can still see it
+	void retire(void* object, void (*destroy)(void*));
+
+	// advances the epoch when every pinned reader is in the current one and frees what became unreachable
+	// returns the number of objects freed
+	size_t collect();
+
+	size_t pending() const { return retired.size(); }
+
+private:
+
+	// one cache line per slot, so readers pinning in parallel do not contend on the same line
+	struct Slot {
+		std::atomic<uint64_t> state{ 0 }; // 0 when free, (epoch << 1) | 1 while a reader is pinned
+		char padding[64 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	struct Retired {
+		uint64_t epoch;
+		void* object;
+		void (*destroy)(void*);
+	};
+
+	Slot slots[SLOTS];
+	std::atomic<uint64_t> epoch{ 0 };
+	std::deque<Retired> retired; // in retirement order, so also in epoch order
+
+	size_t pin();
+	void unpin(size_t slot) { slots[slot].state.store(0, std::memory_order_release); }
+};
@@ -0,0 +1,40 @@
+#include "FuzzyMatch.h"
+#include <algorithm>
+#include <unordered_set>
+
+std::vector<FuzzyMatch> rank_fuzzy_matches(std::unordered_map<std::string, FuzzyMatch>& result_map, double alpha)
+{
+	std::vector<FuzzyMatch> result_vec;
+	for (auto& pair : result_map) {
+		FuzzyMatch& match = pair.second;
+		match.score = match.frequency - alpha * match.edit_distance;
+		result_vec.push_back(match);
+	}
+
+	std::sort(result_vec.begin(), result_vec.end()); // uses operator<
+
+	return result_vec;
+}
+
+void keep_prefix_matches(std::vector<FuzzyMatch>& matches, const std::vector<std::string>& words_with_prefix, int k)
+{
+	std::unordered_set<std::string> prefix_words_set(words_with_prefix.begin(), words_with_prefix.end());
+	
+	for (size_t i = 0; i < matches.size(); /* no i++ here */) { // Note: no i++ in the loop header
+		bool found_in_prefix = false;
+		if (prefix_words_set.count(matches[i].word)) { // count returns 1 if found, 0 if not
+			found_in_prefix = true;
+			matches[i].score = matches[i].score + 10;
+		}
+		if (!found_in_prefix) {
+			matches.erase(matches.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	if ((int)matches.size() > k) {
+		matches.resize(k); // keep only top k
+	}
+}
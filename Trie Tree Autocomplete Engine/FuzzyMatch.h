@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct FuzzyMatch {
+	std::string word;
+	int frequency;
+	int edit_distance;
+	double score = 0; // set by rank_fuzzy_matches
+
+	bool operator<(const FuzzyMatch& other) const {
+		// --- NEW LOGIC FOR EDIT_DISTANCE == 0 PRIORITIZATION ---
+
+		// Case 1: 'this' has edit_distance 0, 'other' does not.
+		// 'this' should come before 'other' (return true).
+		if (this->edit_distance == 0 && other.edit_distance != 0) {
+			return true;
+		}
+
+		// Case 2: 'other' has edit_distance 0, 'this' does not.
+		// 'this' should come after 'other' (return false).
+		if (this->edit_distance != 0 && other.edit_distance == 0) {
+			return false;
+		}
+
+		// --- EXISTING LOGIC (when edit_distance status is the same for both) ---
+		// This part is reached if:
+		// A) Both 'this' and 'other' have edit_distance == 0
+		// B) Both 'this' and 'other' have edit_distance > 0
+
+		// Primary sort: descending by score
+		// If scores are different, the one with the higher score comes first.
+		// (score > other.score means 'this' is "less than" 'other' if we want descending order)
+		if (score != other.score) {
+			return score > other.score;
+		}
+
+		// Secondary sort (for ties in score): ascending by word (lexicographical)
+		// If scores are equal, the one with the lexicographically smaller word comes first.
+		return word < other.word;
+	}
+};
+
+// Ranking shared by every fuzzy backend, so they all order and filter their results the same way.
+
+// scores every match as frequency - alpha * edit_distance and sorts them with FuzzyMatch::operator<
+std::vector<FuzzyMatch> rank_fuzzy_matches(std::unordered_map<std::string, FuzzyMatch>& result_map, double alpha);
+
+// keeps only the matches that are also among the top prefix completions (boosting their score) and truncates to k
+void keep_prefix_matches(std::vector<FuzzyMatch>& matches, const std::vector<std::string>& words_with_prefix, int k);
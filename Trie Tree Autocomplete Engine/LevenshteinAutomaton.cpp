@@ -0,0 +1,75 @@
+#include "LevenshteinAutomaton.h"
+#include <algorithm>
+
+const int LevenshteinAutomaton::DEAD;
+const int LevenshteinAutomaton::UNKNOWN;
+
+LevenshteinAutomaton::LevenshteinAutomaton(const std::string& input, int max_edits)
+	: input(input), max_edits(std::max(0, std::min(max_edits, 254))), width(input.size() + 1), class_count(1)
+{
+	std::fill(letter_class, letter_class + 26, 0);
+	class_letter[0] = '\0'; // never equal to an input letter, so class 0 mismatches everywhere
+	for (char ch : input) {
+		if (ch < 'a' || ch > 'z') continue;
+		int& cls = letter_class[ch - 'a'];
+		if (cls == 0) {
+			cls = class_count;
+			class_letter[class_count++] = ch;
+		}
+	}
+
+	const uint8_t cap = static_cast<uint8_t>(this->max_edits + 1);
+
+	// the dead state goes first so that it is state 0
+	intern(std::string(width, static_cast<char>(cap)));
+
+	// empty path: reaching input[0, i) takes i deletions
+	std::string row(width, 0);
+	for (size_t i = 0; i < width; ++i) {
+		row[i] = static_cast<char>(std::min<size_t>(i, cap));
+	}
+	start_state = intern(row);
+}
+
+int LevenshteinAutomaton::intern(const std::string& row)
+{
+	auto it = state_ids.find(row);
+	if (it != state_ids.end()) return it->second;
+
+	int id = static_cast<int>(rows.size() / width);
+	rows.insert(rows.end(), row.begin(), row.end());
+	transitions.resize(transitions.size() + class_count, UNKNOWN);
+	state_ids.emplace(row, id);
+	return id;
+}
+
+int LevenshteinAutomaton::step(int state, char ch)
+{
+	if (ch < 'a' || ch > 'z' || state == DEAD) return DEAD;
+
+	int cls = letter_class[ch - 'a'];
+	size_t slot = static_cast<size_t>(state) * class_count + cls;
+	if (transitions[slot] != UNKNOWN) return transitions[slot];
+
+	// one DP row update, done once per (state, letter class) for the lifetime of the automaton
+	const int cap = max_edits + 1;
+	const char letter = class_letter[cls];
+	std::string next(width, 0);
+	size_t row = static_cast<size_t>(state) * width;
+
+	int value = std::min<int>(rows[row] + 1, cap);
+	next[0] = static_cast<char>(value);
+	bool alive = value <= max_edits;
+	for (size_t j = 1; j < width; ++j) {
+		int substitution = rows[row + j - 1] + (input[j - 1] == letter ? 0 : 1);
+		int insertion = rows[row + j] + 1;
+		int deletion = static_cast<uint8_t>(next[j - 1]) + 1;
+		value = std::min(cap, std::min(substitution, std::min(insertion, deletion)));
+		next[j] = static_cast<char>(value);
+		alive = alive || value <= max_edits;
+	}
+
+	int target = alive ? intern(next) : DEAD;
+	transitions[slot] = target; // intern may have grown the table, so index it again
+	return target;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+
+// Deterministic Levenshtein automaton for one fuzzy query.
+// A state is a Levenshtein DP row with every cell capped at max_edits + 1. Capping makes the number of
+// distinct rows small (a handful of dozens for distances 1-3), so rows are interned as small integer states
+// and every transition is computed once and then served from a table.
+// Letters that do not occur in the input behave identically and share one column of that table.
+// Intersecting the automaton with a trie costs one table lookup per visited child instead of a row update.
+class LevenshteinAutomaton {
+
+public:
+
+	static const int DEAD = 0; // no word continuing from here can be within max_edits
+
+	LevenshteinAutomaton(const std::string& input, int max_edits);
+
+	int start() const { return start_state; }
+
+	// state reached by appending ch to the path, computed on first use
+	int step(int state, char ch);
+
+	// edit distance between the input and the path leading to state, -1 when it exceeds max_edits
+	int distance(int state) const {
+		int value = rows[static_cast<size_t>(state) * width + width - 1];
+		return value <= max_edits ? value : -1;
+	}
+
+	size_t state_count() const { return rows.size() / width; }
+
+private:
+
+	static const int UNKNOWN = -1;
+
+	std::string input;
+	int max_edits;
+	size_t width;
+
+	std::vector<uint8_t> rows;      // row of state s at [s * width, (s + 1) * width)
+	std::vector<int> transitions;   // next state for (state, letter class), UNKNOWN until computed
+	std::unordered_map<std::string, int> state_ids;
+	int start_state;
+
+	// letter class: 0 for letters absent from the input, otherwise one class per distinct input letter
+	int letter_class[26];
+	char class_letter[27];
+	int class_count;
+
+	int intern(const std::string& row);
+};
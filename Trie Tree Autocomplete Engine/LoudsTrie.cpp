@@ -0,0 +1,172 @@
+#include "LoudsTrie.h"
+#include "Trie.h"
+#include <queue>
+
+namespace {
+
+	// range of sorted words that share the path leading to the node being emitted
+	struct PendingNode {
+		size_t begin;
+		size_t end;
+		size_t depth;
+	};
+
+}
+
+LoudsTrie::LoudsTrie(const std::vector<std::pair<std::string, int>>& sorted_words)
+{
+	build(sorted_words);
+}
+
+LoudsTrie::LoudsTrie(const Trie& trie)
+{
+	build(trie.get_all_words());
+}
+
+void LoudsTrie::build(const std::vector<std::pair<std::string, int>>& sorted_words)
+{
+	// breadth-first over ranges of the sorted list, each range becomes one node
+	std::vector<PendingNode> queue;
+	queue.push_back(PendingNode{ 0, sorted_words.size(), 0 });
+	labels.push_back('\0');
+
+	// virtual super-root with the real root as its only child
+	louds.push_back(true);
+	louds.push_back(false);
+
+	for (size_t head = 0; head < queue.size(); ++head) {
+		PendingNode current = queue[head];
+		size_t i = current.begin;
+
+		// the word spelled exactly by the path sorts first in its range (the last copy wins if it repeats)
+		bool is_end_of_word = false;
+		int frequency = 0;
+		while (i < current.end && sorted_words[i].first.size() == current.depth) {
+			is_end_of_word = true;
+			frequency = sorted_words[i].second;
+			++i;
+		}
+		terminal.push_back(is_end_of_word);
+		if (is_end_of_word) {
+			frequencies.push_back(frequency);
+		}
+
+		// one 1-bit per distinct next letter, children are queued in letter order
+		while (i < current.end) {
+			char letter = sorted_words[i].first[current.depth];
+			size_t group_begin = i;
+			while (i < current.end && sorted_words[i].first[current.depth] == letter) ++i;
+
+			louds.push_back(true);
+			labels.push_back(letter);
+			queue.push_back(PendingNode{ group_begin, i, current.depth + 1 });
+		}
+		louds.push_back(false);
+	}
+
+	louds.build_index();
+	terminal.build_index();
+	labels.shrink_to_fit();
+	frequencies.shrink_to_fit();
+}
+
+void LoudsTrie::children_of(size_t node, size_t& first_child, size_t& child_count) const
+{
+	// the child list of node i starts right after the (i + 1)-th 0-bit and runs until the next 0-bit
+	size_t start = louds.select0(node + 1) + 1;
+	size_t end = start;
+	while (end < louds.size() && louds.get(end)) ++end;
+
+	first_child = louds.rank1(start);
+	child_count = end - start;
+}
+
+long long LoudsTrie::find_node(const std::string& word) const
+{
+	if (labels.empty()) return -1;
+
+	size_t node = 0;
+	for (char ch : word) {
+		size_t first_child;
+		size_t child_count;
+		children_of(node, first_child, child_count);
+
+		// siblings are consecutive node numbers with sorted labels
+		size_t next = first_child;
+		size_t last = first_child + child_count;
+		while (next < last && labels[next] < ch) ++next;
+		if (next == last || labels[next] != ch) return -1;
+		node = next;
+	}
+	return static_cast<long long>(node);
+}
+
+bool LoudsTrie::contains(const std::string& word) const
+{
+	long long node = find_node(word);
+	return node >= 0 && terminal.get(static_cast<size_t>(node));
+}
+
+int LoudsTrie::frequency_of(const std::string& word) const
+{
+	long long node = find_node(word);
+	return node >= 0 && terminal.get(static_cast<size_t>(node)) ? frequency_at(static_cast<size_t>(node)) : 0;
+}
+
+std::vector<std::pair<std::string, int>> LoudsTrie::get_words_with_prefix(const std::string& prefix) const
+{
+	std::vector<std::pair<std::string, int>> results;
+
+	long long node = find_node(prefix);
+	if (node < 0) return results;
+
+	std::string current = prefix;
+	dfs(static_cast<size_t>(node), current, results);
+
+	return results;
+}
+
+void LoudsTrie::dfs(size_t node, std::string& current, std::vector<std::pair<std::string, int>>& results) const
+{
+	if (terminal.get(node)) {
+		results.emplace_back(current, frequency_at(node));
+	}
+
+	size_t first_child;
+	size_t child_count;
+	children_of(node, first_child, child_count);
+
+	for (size_t child = first_child; child < first_child + child_count; ++child) {
+		current.push_back(labels[child]);
+		dfs(child, current, results);
+		current.pop_back();
+	}
+}
+
+std::vector<std::string> LoudsTrie::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	std::vector<std::pair<std::string, int>> all_words = get_words_with_prefix(prefix);
+
+	auto cmp = [](const auto& a, const auto& b) {
+		// max heap based on frequency
+		return a.second < b.second || (a.second == b.second && a.first > b.first);
+		};
+
+	std::priority_queue <
+		std::pair<std::string, int>,
+		std::vector<std::pair<std::string, int>>,
+		decltype(cmp)
+	> pq(cmp, all_words);
+
+	std::vector<std::string> result;
+	for (int i = 0; i < k && !pq.empty(); i++) {
+		result.push_back(pq.top().first);
+		pq.pop();
+	}
+	return result;
+}
+
+size_t LoudsTrie::memory_usage() const
+{
+	return louds.memory_usage() + terminal.memory_usage() + labels.capacity() + frequencies.capacity() * sizeof(int32_t);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "SuccinctBitVector.h"
+
+class Trie;
+
+
+// Succinct, read-only trie for dictionaries too large for the pointer-based Trie.
+// The shape is LOUDS-encoded (level-order unary degree sequence): nodes are numbered in breadth-first order
+// and every node writes one 1-bit per child followed by a 0-bit, after a "10" for a virtual super-root.
+// That is about two bits per node, plus one label byte, one end-of-word bit and a frequency for each word.
+// Navigation uses rank/select on the bit vector:
+//     children of node i occupy the 1-bits between the (i + 1)-th and (i + 2)-th 0-bit,
+//     and the 1-bit at position p belongs to node rank1(p).
+class LoudsTrie {
+
+public:
+
+	LoudsTrie() = default;
+
+	// words must be sorted and unique
+	explicit LoudsTrie(const std::vector<std::pair<std::string, int>>& sorted_words);
+	explicit LoudsTrie(const Trie& trie);
+
+	bool contains(const std::string& word) const;
+	int frequency_of(const std::string& word) const; // 0 when the word is not in the dictionary
+
+	// every word starting with prefix, in lexicographic order
+	std::vector<std::pair<std::string, int>> get_words_with_prefix(const std::string& prefix) const;
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+
+	size_t node_count() const { return labels.size(); }
+	size_t word_count() const { return frequencies.size(); }
+	size_t memory_usage() const;
+
+private:
+
+	SuccinctBitVector louds;
+	SuccinctBitVector terminal; // bit i set when node i ends a word
+	std::vector<char> labels;   // label of the edge into node i, labels[0] belongs to the root and is unused
+	std::vector<int32_t> frequencies; // one entry per word, indexed by terminal.rank1(node)
+
+	void build(const std::vector<std::pair<std::string, int>>& sorted_words);
+
+	// first child number and child count of node
+	void children_of(size_t node, size_t& first_child, size_t& child_count) const;
+	long long find_node(const std::string& word) const;
+	int frequency_at(size_t node) const { return frequencies[terminal.rank1(node)]; }
+
+	void dfs(size_t node, std::string& current, std::vector<std::pair<std::string, int>>& results) const;
+};
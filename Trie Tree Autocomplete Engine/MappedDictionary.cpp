@@ -0,0 +1,345 @@
+#include "MappedDictionary.h"
+#include "BitUtils.h"
+#include <iostream>
+#include <queue>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+const uint32_t DictionaryNode::END_OF_WORD;
+const uint32_t DictionaryNode::LETTERS;
+const uint32_t MappedDictionary::NO_NODE;
+
+bool MappedDictionary::open(const std::string& filename, bool writable)
+{
+	close();
+
+	if (!file.open(filename, writable)) {
+		std::cerr << "No saved data found (" << filename << ").\n";
+		return false;
+	}
+
+	// only the header is checked here, so opening does not depend on the dictionary size
+	const DictionaryHeader* header = reinterpret_cast<const DictionaryHeader*>(file.data());
+	if (file.size() < sizeof(DictionaryHeader)
+		|| !std::equal(header->magic, header->magic + sizeof(header->magic), DICTIONARY_MAGIC)
+		|| header->version != DICTIONARY_VERSION) {
+		std::cerr << "Not a binary dictionary (" << filename << ").\n";
+		file.close();
+		return false;
+	}
+
+	if (header->node_count == 0 || file.size() != sizeof(DictionaryHeader) + static_cast<size_t>(header->node_count) * sizeof(DictionaryNode)) {
+		std::cerr << "Truncated binary dictionary (" << filename << ").\n";
+		file.close();
+		return false;
+	}
+
+	nodes = reinterpret_cast<const DictionaryNode*>(file.data() + sizeof(DictionaryHeader));
+	count = header->node_count;
+	generation = header->generation;
+	this->filename = filename;
+	this->writable = writable;
+	opened_version = ++dictionary_version;
+	return true;
+}
+
+void MappedDictionary::close()
+{
+	file.close();
+	nodes = nullptr;
+	count = 0;
+	generation = 0;
+	writable = false;
+	subtree_versions.clear();
+	++dictionary_version;
+}
+
+uint64_t MappedDictionary::version(const std::string& prefix) const
+{
+	if (!nodes) return dictionary_version;
+
+	// the deepest node of prefix, as in Trie::version
+	uint32_t node = 0;
+	for (char ch : prefix) {
+		uint32_t next = child(node, ch - 'a');
+		if (next == NO_NODE) break;
+		node = next;
+	}
+
+	auto changed = subtree_versions.find(node);
+	return changed != subtree_versions.end() ? changed->second : opened_version;
+}
+
+int MappedDictionary::subtree_max_frequency(uint32_t node) const
+{
+	const DictionaryNode& current = nodes[node];
+	int best = (current.child_mask & DictionaryNode::END_OF_WORD) ? current.frequency : INT_MIN;
+
+	// the children are the consecutive nodes starting at first_child
+	uint32_t end = current.first_child + popcount32(current.child_mask & DictionaryNode::LETTERS);
+	for (uint32_t id = current.first_child; id < end && id < count; ++id) {
+		if (id > node) best = std::max(best, nodes[id].max_frequency);
+	}
+	return best;
+}
+
+bool MappedDictionary::add_frequency(const std::string& word, int delta)
+{
+	if (!nodes || !writable) return false;
+
+	std::vector<uint32_t> path{ 0 };
+	for (char ch : word) {
+		uint32_t next = child(path.back(), ch - 'a');
+		if (next == NO_NODE) return false;
+		path.push_back(next);
+	}
+
+	// the pages written here become private copies, the file itself is untouched
+	DictionaryNode* writable_nodes = reinterpret_cast<DictionaryNode*>(file.writable_data() + sizeof(DictionaryHeader));
+	DictionaryNode& target = writable_nodes[path.back()];
+	if (!(target.child_mask & DictionaryNode::END_OF_WORD)) return false;
+	target.frequency += delta;
+
+	++dictionary_version;
+	for (uint32_t changed : path) {
+		subtree_versions[changed] = dictionary_version;
+	}
+
+	// bottom-up, stopping at the first ancestor whose maximum does not change
+	for (size_t i = path.size(); i-- > 0;) {
+		int updated = subtree_max_frequency(path[i]);
+		if (updated == nodes[path[i]].max_frequency && i + 1 < path.size()) break;
+		writable_nodes[path[i]].max_frequency = updated;
+	}
+	return true;
+}
+
+bool MappedDictionary::rewrite(uint32_t new_generation)
+{
+	if (!nodes) return false;
+
+	// written aside first, so the current file survives a failed write
+	std::string temporary = filename + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		DictionaryHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+		header.generation = new_generation;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(nodes), static_cast<size_t>(count) * sizeof(DictionaryNode));
+		out.close();
+		if (!out) {
+			std::cerr << "Failed to write the binary dictionary (" << temporary << ").\n";
+			std::remove(temporary.c_str()); // never leave a partial dictionary behind
+			return false;
+		}
+	}
+
+	// Windows refuses to replace a mapped file, so unmap before swapping the files; the nodes updated since
+	// opening only live in the mapping, they are kept aside to put back should the original stay in place
+	std::vector<std::pair<uint32_t, DictionaryNode>> updated;
+	for (const auto& changed : subtree_versions) {
+		updated.emplace_back(changed.first, nodes[changed.first]);
+	}
+	std::string path = filename;
+	bool was_writable = writable;
+	close();
+
+	if (!replace_file(temporary, path)) {
+		std::cerr << "Failed to replace the binary dictionary (" << path << ").\n";
+		std::remove(temporary.c_str());
+		if (open(path, was_writable) && !updated.empty()) {
+			DictionaryNode* writable_nodes = reinterpret_cast<DictionaryNode*>(file.writable_data() + sizeof(DictionaryHeader));
+			for (const auto& node : updated) {
+				writable_nodes[node.first] = node.second;
+				subtree_versions[node.first] = dictionary_version;
+			}
+		}
+		return false;
+	}
+	return open(path, was_writable);
+}
+
+uint32_t MappedDictionary::child(uint32_t node, size_t index) const
+{
+	uint32_t mask = nodes[node].child_mask & DictionaryNode::LETTERS;
+	if (index >= 26 || !((mask >> index) & 1u)) return NO_NODE;
+
+	uint32_t id = nodes[node].first_child + popcount32(mask & ((1u << index) - 1));
+	// the header was checked but the nodes were not: stay inside the mapping, and since children always
+	// follow their parent in breadth-first order, refuse links backwards so a corrupt file cannot loop
+	return id > node && id < count ? id : NO_NODE;
+}
+
+uint32_t MappedDictionary::find_node(const std::string& word) const
+{
+	if (!nodes) return NO_NODE;
+
+	uint32_t node = 0;
+	for (char ch : word) {
+		node = child(node, ch - 'a');
+		if (node == NO_NODE) return NO_NODE;
+	}
+	return node;
+}
+
+bool MappedDictionary::contains(const std::string& word) const
+{
+	uint32_t node = find_node(word);
+	return node != NO_NODE && (nodes[node].child_mask & DictionaryNode::END_OF_WORD);
+}
+
+int MappedDictionary::frequency_of(const std::string& word) const
+{
+	return contains(word) ? nodes[find_node(word)].frequency : 0;
+}
+
+std::vector<std::string> MappedDictionary::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	// the same best-first branch and bound as Trie::get_top_k_with_prefix, over the stored subtree maxima
+	std::vector<std::string> result;
+
+	uint32_t node = find_node(prefix);
+	if (node == NO_NODE || k <= 0 || nodes[node].max_frequency == INT_MIN) return result;
+
+	struct Candidate {
+		int value;
+		std::string text;
+		uint32_t node; // NO_NODE for a finished word
+	};
+
+	auto cmp = [](const Candidate& a, const Candidate& b) {
+		return a.value < b.value || (a.value == b.value && a.text > b.text);
+		};
+
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(cmp)> pq(cmp);
+	pq.push(Candidate{ nodes[node].max_frequency, prefix, node });
+
+	while (!pq.empty() && (int)result.size() < k) {
+		Candidate top = pq.top();
+		pq.pop();
+
+		if (top.node == NO_NODE) {
+			result.push_back(top.text);
+			continue;
+		}
+
+		const DictionaryNode& current = nodes[top.node];
+		if (current.child_mask & DictionaryNode::END_OF_WORD) {
+			pq.push(Candidate{ current.frequency, top.text, NO_NODE });
+		}
+		for (char ch = 'a'; ch <= 'z'; ++ch) {
+			uint32_t next = child(top.node, ch - 'a');
+			if (next != NO_NODE) {
+				pq.push(Candidate{ nodes[next].max_frequency, top.text + ch, next });
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<FuzzyMatch> MappedDictionary::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+{
+	std::vector<FuzzyMatch> all_matches = get_ranked_fuzzy_matches(input, max_edits);
+
+	std::vector<std::string> words_with_prefix = this->get_top_k_with_prefix(input, k);
+	keep_prefix_matches(all_matches, words_with_prefix, k);
+
+	return all_matches;
+}
+
+std::vector<FuzzyMatch> MappedDictionary::get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha) const
+{
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	if (!nodes || max_edits < 0) return {};
+
+	// the row for the empty path: reaching input[0, i) takes i deletions
+	std::vector<int> rows(input.size() + 1);
+	for (size_t i = 0; i < rows.size(); ++i) {
+		rows[i] = static_cast<int>(i);
+	}
+
+	std::string current;
+	search_fuzzy(0, input, current, rows, max_edits, result_map);
+
+	return rank_fuzzy_matches(result_map, alpha);
+}
+
+void MappedDictionary::search_fuzzy(uint32_t node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// Levenshtein DP rows stacked per depth, as in Trie::search_fuzzy
+	const size_t width = target.size() + 1;
+	const size_t row = current.size() * width;
+	const size_t next_row = row + width;
+
+	if ((nodes[node].child_mask & DictionaryNode::END_OF_WORD) && rows[row + width - 1] <= max_edits) {
+		results[current] = FuzzyMatch{ current, nodes[node].frequency, rows[row + width - 1] };
+	}
+
+	if (rows.size() < next_row + width) {
+		rows.resize(next_row + width);
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		uint32_t next = child(node, ch - 'a');
+		if (next == NO_NODE) continue;
+
+		rows[next_row] = rows[row] + 1;
+		int row_min = rows[next_row];
+
+		for (size_t j = 1; j < width; ++j) {
+			int substitution = rows[row + j - 1] + (target[j - 1] == ch ? 0 : 1);
+			int insertion = rows[row + j] + 1;
+			int deletion = rows[next_row + j - 1] + 1;
+			rows[next_row + j] = std::min(substitution, std::min(insertion, deletion));
+			row_min = std::min(row_min, rows[next_row + j]);
+		}
+
+		if (row_min > max_edits) continue;
+
+		current.push_back(ch);
+		search_fuzzy(next, target, current, rows, max_edits, results);
+		current.pop_back();
+	}
+}
+
+std::vector<std::pair<std::string, int>> MappedDictionary::get_all_words() const
+{
+	std::vector<std::pair<std::string, int>> words;
+	if (!nodes) return words;
+
+	std::string current;
+	collect_all_words(0, current, words);
+	return words;
+}
+
+std::vector<std::pair<std::string, int>> MappedDictionary::get_words_with_prefix(const std::string& prefix) const
+{
+	std::vector<std::pair<std::string, int>> words;
+	uint32_t node = find_node(prefix);
+	if (node == NO_NODE) return words;
+
+	std::string current = prefix;
+	collect_all_words(node, current, words);
+	return words;
+}
+
+void MappedDictionary::collect_all_words(uint32_t node, std::string& current, std::vector<std::pair<std::string, int>>& out) const
+{
+	if (nodes[node].child_mask & DictionaryNode::END_OF_WORD) {
+		out.emplace_back(current, nodes[node].frequency);
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ch++) {
+		uint32_t next = child(node, ch - 'a');
+		if (next != NO_NODE) {
+			current.push_back(ch);
+			collect_all_words(next, current, out);
+			current.pop_back();
+		}
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "MappedFile.h"
+#include "FuzzyMatch.h"
+
+
+// Binary dictionary format, written by Trie::save_to_file(filename, DictionaryFormat::BINARY):
+//
+//     DictionaryHeader                          24 bytes
+//     DictionaryNode[node_count]                16 bytes each, breadth-first order, node 0 is the root
+//
+// The children of a node are consecutive nodes in letter order starting at first_child, so the child for
+// letter i is first_child + popcount(child letters below i), the same rule the in-memory Trie uses for its slots.
+// Integers are stored in native (little-endian) byte order. Readers reject any other magic or version, so
+// bump DICTIONARY_VERSION whenever the layout changes.
+
+const char DICTIONARY_MAGIC[8] = { 'C', 'S', 'D', 'I', 'C', 'T', 'B', 'N' };
+const uint32_t DICTIONARY_VERSION = 2; // 2: generation added to the header
+
+struct DictionaryHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t node_count;
+	uint32_t generation; // bumped by every rewrite, ties an UpdateLog to the image it was written against
+	uint32_t reserved;
+};
+
+struct DictionaryNode {
+	static const uint32_t END_OF_WORD = 1u << 31; // stored in the otherwise unused top bit of child_mask
+	static const uint32_t LETTERS = (1u << 26) - 1;
+
+	uint32_t child_mask;    // bit i set when the child for 'a' + i exists, plus END_OF_WORD
+	uint32_t first_child;
+	int32_t frequency;
+	int32_t max_frequency;  // highest frequency in the subtree, INT_MIN when it holds no word
+};
+
+static_assert(sizeof(DictionaryHeader) == 24, "the header is part of the file format");
+static_assert(sizeof(DictionaryNode) == 16, "nodes are part of the file format");
+
+
+// Dictionary served straight from a memory-mapped binary file.
+// Opening only validates the header, nothing is parsed or allocated, so it takes the same time for any
+// dictionary size; the pages holding the nodes a query touches are faulted in on first use.
+// Queries follow the Trie's semantics exactly (best-first top-k over max_frequency, DP-row fuzzy search).
+// Opened writable, the mapping is copy-on-write: frequencies can be updated in memory (see add_frequency)
+// while the file stays as it is until rewrite() replaces it.
+class MappedDictionary {
+
+public:
+
+	bool open(const std::string& filename, bool writable = false);
+	void close();
+	bool is_open() const { return nodes != nullptr; }
+
+	uint32_t get_generation() const { return generation; }
+
+	// like Trie::version, for the whole dictionary and for the subtree of prefix; (re)opening changes both
+	uint64_t version() const { return dictionary_version; }
+	uint64_t version(const std::string& prefix) const;
+
+	// adds delta to the frequency of an existing word and fixes the subtree maxima above it, like Trie::add_frequency
+	// only possible on a writable dictionary, false when the word is missing
+	bool add_frequency(const std::string& word, int delta);
+
+	// writes the current nodes (updates included) over the file the dictionary was opened from,
+	// stamped with the given generation, and maps the new file; the old file is replaced in one step once the new
+	// one is on disk. On failure the dictionary stays as it was, updates included
+	bool rewrite(uint32_t new_generation);
+
+	bool contains(const std::string& word) const;
+	int frequency_of(const std::string& word) const; // 0 when the word is not in the dictionary
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	// every word with its frequency, sorted lexicographically
+	std::vector<std::pair<std::string, int>> get_all_words() const;
+	std::vector<std::pair<std::string, int>> get_words_with_prefix(const std::string& prefix) const;
+
+	size_t node_count() const { return count; }
+
+private:
+
+	static const uint32_t NO_NODE = UINT32_MAX;
+
+	MappedFile file;
+	std::string filename;
+	bool writable = false;
+	const DictionaryNode* nodes = nullptr;
+	uint32_t count = 0;
+	uint32_t generation = 0;
+
+	// never reset, so a reopened file cannot reuse the version of an earlier one; the nodes have no room for a
+	// version of their own, so only the few touched by add_frequency since opening get one, in subtree_versions
+	uint64_t dictionary_version = 0;
+	uint64_t opened_version = 0;
+	std::unordered_map<uint32_t, uint64_t> subtree_versions;
+
+	// NO_NODE when there is no such child (or the file points outside of itself)
+	uint32_t child(uint32_t node, size_t index) const;
+	uint32_t find_node(const std::string& word) const;
+	int subtree_max_frequency(uint32_t node) const;
+
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
+	void search_fuzzy(uint32_t node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+
+	void collect_all_words(uint32_t node, std::string& current, std::vector<std::pair<std::string, int>>& out) const;
+};
@@ -0,0 +1,151 @@
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& filename, bool copy_on_write)
+{
+	close();
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		// an empty file cannot be mapped
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* address = MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	if (address == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	file_handle = file;
+	mapping_handle = mapping;
+	view = static_cast<const char*>(address);
+	length = static_cast<size_t>(file_size.QuadPart);
+	this->copy_on_write = copy_on_write;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (view) UnmapViewOfFile(view);
+	if (mapping_handle) CloseHandle(mapping_handle);
+	if (file_handle) CloseHandle(file_handle);
+
+	view = nullptr;
+	length = 0;
+	copy_on_write = false;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept
+{
+	std::swap(view, other.view);
+	std::swap(length, other.length);
+	std::swap(copy_on_write, other.copy_on_write);
+	std::swap(file_handle, other.file_handle);
+	std::swap(mapping_handle, other.mapping_handle);
+}
+
+bool replace_file(const std::string& temporary, const std::string& target)
+{
+	HANDLE file = CreateFileA(temporary.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	bool flushed = FlushFileBuffers(file) != 0;
+	CloseHandle(file);
+	if (!flushed) return false;
+
+	// write-through: the move itself is on disk before this returns
+	return MoveFileExA(temporary.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename, bool copy_on_write)
+{
+	close();
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		// an empty file cannot be mapped
+		::close(fd);
+		return false;
+	}
+
+	void* address = copy_on_write
+		? mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+		: mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // the mapping keeps its own reference to the file
+	if (address == MAP_FAILED) return false;
+
+	view = static_cast<const char*>(address);
+	length = static_cast<size_t>(info.st_size);
+	this->copy_on_write = copy_on_write;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (view) munmap(const_cast<char*>(view), length);
+
+	view = nullptr;
+	length = 0;
+	copy_on_write = false;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept
+{
+	std::swap(view, other.view);
+	std::swap(length, other.length);
+	std::swap(copy_on_write, other.copy_on_write);
+}
+
+bool replace_file(const std::string& temporary, const std::string& target)
+{
+	int fd = ::open(temporary.c_str(), O_RDWR);
+	if (fd < 0) return false;
+	bool flushed = fsync(fd) == 0;
+	::close(fd);
+	if (!flushed) return false;
+
+	// rename replaces an existing target atomically
+	if (rename(temporary.c_str(), target.c_str()) != 0) return false;
+
+	// the new directory entry is only durable once the directory itself is flushed
+	size_t slash = target.find_last_of('/');
+	std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : target.substr(0, slash);
+	int directory_fd = ::open(directory.c_str(), O_RDONLY);
+	if (directory_fd >= 0) {
+		fsync(directory_fd);
+		::close(directory_fd);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+
+// Memory mapping of a whole file (MapViewOfFile on Windows, mmap elsewhere).
+// Opening costs the same whatever the file size: pages are only read from disk when they are first touched,
+// and a file mapped by several processes shares one copy in the page cache.
+// A copy-on-write mapping can also be modified: a touched page becomes a private copy, and the file never changes.
+class MappedFile {
+
+public:
+
+	MappedFile() = default;
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept { swap(other); }
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		if (this != &other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	bool open(const std::string& filename, bool copy_on_write = false);
+	void close();
+
+	bool is_open() const { return view != nullptr; }
+	const char* data() const { return view; }
+	char* writable_data() const { return copy_on_write ? const_cast<char*>(view) : nullptr; }
+	size_t size() const { return length; }
+
+private:
+
+	const char* view = nullptr;
+	size_t length = 0;
+	bool copy_on_write = false;
+
+#if defined(_WIN32)
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif
+
+	void swap(MappedFile& other) noexcept;
+};
+
+
+// Moves temporary over target once the contents of temporary are on disk, in one step: target is always either
+// the old file or the complete new one, even across a crash. target is never removed first, and on failure it is
+// left as it was. Nothing may have target mapped on Windows, which refuses to replace a mapped file.
+bool replace_file(const std::string& temporary, const std::string& target);
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include "BitUtils.h"
+
+
+// Myers' bit-parallel edit distance (in Hyyro's formulation for global distance) for patterns of up to 64 characters.
+// One column of the Levenshtein table between the pattern and a growing text is encoded as two 64-bit vertical
+// delta masks (pv: +1 steps, mv: -1 steps) plus the value of its bottom cell, so appending a text character
+// is a handful of ALU operations regardless of the pattern length.
+struct MyersState {
+	uint64_t pv;
+	uint64_t mv;
+	int score; // edit distance between the whole pattern and the text consumed so far
+};
+
+class MyersPattern {
+
+public:
+
+	static const size_t MAX_LENGTH = 64;
+
+	explicit MyersPattern(const std::string& pattern) : length(static_cast<int>(pattern.size())) {
+		std::fill(peq, peq + 26, uint64_t(0));
+		for (int i = 0; i < length; ++i) {
+			char ch = pattern[i];
+			if (ch >= 'a' && ch <= 'z') peq[ch - 'a'] |= uint64_t(1) << i;
+		}
+		mask = length == 64 ? ~uint64_t(0) : (uint64_t(1) << length) - 1;
+		high_bit = length == 0 ? 0 : uint64_t(1) << (length - 1);
+	}
+
+	// column for the empty text: cell i is i, every vertical step is +1
+	MyersState start() const { return MyersState{ mask, 0, length }; }
+
+	MyersState step(const MyersState& state, char ch) const {
+		uint64_t eq = ch >= 'a' && ch <= 'z' ? peq[ch - 'a'] : 0;
+		uint64_t pv = state.pv;
+		uint64_t mv = state.mv;
+
+		uint64_t xv = eq | mv;
+		uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+		uint64_t ph = mv | ~(xh | pv);
+		uint64_t mh = pv & xh;
+
+		int score = state.score;
+		if (length == 0) score += 1;
+		else if (ph & high_bit) score += 1;
+		else if (mh & high_bit) score -= 1;
+
+		// the top row of the table is 0, 1, 2, ... so a +1 horizontal step enters at the bottom
+		ph = (ph << 1) | 1;
+		mh <<= 1;
+
+		return MyersState{ (mh | ~(xv | ph)) & mask, ph & xv & mask, score };
+	}
+
+	// no extension of the text can get closer than the smallest cell of the current column
+	// score minus the +1 steps is a cheap lower bound of that minimum, and depth - length is another
+	int lower_bound(const MyersState& state, int depth) const {
+		return std::max(state.score - popcount64(state.pv), depth - length);
+	}
+
+	// full edit distance between the pattern and text
+	int distance(const std::string& text) const {
+		MyersState state = start();
+		for (char ch : text) state = step(state, ch);
+		return state.score;
+	}
+
+private:
+
+	uint64_t peq[26]; // bit i set when pattern[i] is that letter
+	uint64_t mask;
+	uint64_t high_bit;
+	int length;
+};
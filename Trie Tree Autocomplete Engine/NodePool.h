@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <type_traits>
+#include "BitUtils.h"
+
+// Slab allocator for trie nodes.
+// Nodes are carved out of large fixed-size chunks and addressed by 32-bit indices instead of owning pointers,
+// so building a big dictionary costs one allocation per chunk instead of one per character,
+// and destroying it is a handful of frees instead of a recursive destructor chain.
+// Chunks never move once allocated, so a T* obtained through operator[] stays valid for the lifetime of the pool.
+template <typename T>
+class NodePool {
+
+	static_assert(std::is_trivially_destructible<T>::value, "NodePool frees chunks in bulk and never runs destructors");
+
+public:
+
+	static constexpr uint32_t CHUNK_BITS = 12;
+	static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS; // 4096 nodes per slab
+	static constexpr uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+	NodePool() = default;
+	NodePool(const NodePool&) = delete;
+	NodePool& operator=(const NodePool&) = delete;
+	NodePool(NodePool&& other) noexcept : chunks(std::move(other.chunks)), count(other.count) { other.count = 0; }
+	NodePool& operator=(NodePool&& other) noexcept {
+		if (this != &other) {
+			release();
+			chunks = std::move(other.chunks);
+			count = other.count;
+			other.count = 0;
+		}
+		return *this;
+	}
+	~NodePool() { release(); }
+
+	// constructs a fresh node at the end of the pool and returns its index
+	uint32_t allocate() {
+		if ((count & CHUNK_MASK) == 0 && (count >> CHUNK_BITS) == chunks.size()) {
+			chunks.push_back(std::allocator<T>().allocate(CHUNK_SIZE));
+		}
+		uint32_t id = count++;
+		new (&(*this)[id]) T();
+		return id;
+	}
+
+	// constructs count fresh nodes at the end of the pool and returns the index of the first one
+	uint32_t allocate_range(uint32_t count) {
+		uint32_t first = this->count;
+		for (uint32_t i = 0; i < count; ++i) allocate();
+		return first;
+	}
+
+	T& operator[](uint32_t id) { return chunks[id >> CHUNK_BITS][id & CHUNK_MASK]; }
+	const T& operator[](uint32_t id) const { return chunks[id >> CHUNK_BITS][id & CHUNK_MASK]; }
+
+	uint32_t size() const { return count; }
+
+	size_t memory_usage() const { return chunks.size() * CHUNK_SIZE * sizeof(T); }
+
+	// drops every node at once; indices handed out before are invalid afterwards
+	void clear() {
+		release();
+	}
+
+private:
+
+	std::vector<T*> chunks;
+	uint32_t count = 0;
+
+	void release() {
+		for (T* chunk : chunks) {
+			std::allocator<T>().deallocate(chunk, CHUNK_SIZE);
+		}
+		chunks.clear();
+		count = 0;
+	}
+};
+
+// Arena for the dense child arrays of sparse trie nodes.
+// A node with n children owns one block of capacity_for(n) consecutive slots; blocks come in power-of-two
+// size classes so a node only relocates its children when it crosses a power of two, and released blocks
+// are recycled through per-class free lists.
+class ChildSlotPool {
+
+public:
+
+	static constexpr int SIZE_CLASSES = 6; // 1, 2, 4, 8, 16, 32 slots
+
+	static uint32_t capacity_for(int count) {
+		uint32_t capacity = count > 0 ? 1 : 0;
+		while (capacity < static_cast<uint32_t>(count)) capacity <<= 1;
+		return capacity;
+	}
+
+	uint32_t allocate(uint32_t capacity) {
+		std::vector<uint32_t>& free_list = free_blocks[size_class(capacity)];
+		if (!free_list.empty()) {
+			uint32_t offset = free_list.back();
+			free_list.pop_back();
+			return offset;
+		}
+		uint32_t offset = static_cast<uint32_t>(slots.size());
+		slots.resize(slots.size() + capacity);
+		return offset;
+	}
+
+	void release(uint32_t offset, uint32_t capacity) {
+		if (capacity == 0) return;
+		free_blocks[size_class(capacity)].push_back(offset);
+	}
+
+	// slot holding the child for letter index of a node that has that child
+	uint32_t& child_slot(uint32_t child_mask, uint32_t child_block, size_t index) {
+		return slots[child_block + popcount32(child_mask & ((1u << index) - 1))];
+	}
+	const uint32_t& child_slot(uint32_t child_mask, uint32_t child_block, size_t index) const {
+		return slots[child_block + popcount32(child_mask & ((1u << index) - 1))];
+	}
+
+	// adds child id for letter index to a node, updating its mask and relocating its block when it is full
+	void insert(uint32_t& child_mask, uint32_t& child_block, size_t index, uint32_t id) {
+		int count = popcount32(child_mask);
+		int rank = popcount32(child_mask & ((1u << index) - 1));
+		uint32_t capacity = capacity_for(count);
+
+		if (static_cast<uint32_t>(count) < capacity) {
+			// room left in the current block, shift the larger letters one slot to the right
+			for (int i = count; i > rank; --i) {
+				slots[child_block + i] = slots[child_block + i - 1];
+			}
+			slots[child_block + rank] = id;
+		}
+		else {
+			// block is full, move the children into the next size class
+			uint32_t block = allocate(capacity_for(count + 1));
+			for (int i = 0; i < rank; ++i) {
+				slots[block + i] = slots[child_block + i];
+			}
+			slots[block + rank] = id;
+			for (int i = rank; i < count; ++i) {
+				slots[block + i + 1] = slots[child_block + i];
+			}
+			release(child_block, capacity);
+			child_block = block;
+		}
+
+		child_mask |= 1u << index;
+	}
+
+	uint32_t& operator[](uint32_t offset) { return slots[offset]; }
+	const uint32_t& operator[](uint32_t offset) const { return slots[offset]; }
+
+	size_t memory_usage() const { return slots.capacity() * sizeof(uint32_t); }
+
+	uint32_t size() const { return static_cast<uint32_t>(slots.size()); }
+
+	// appends count empty slots and returns the offset of the first one, to be filled in bulk through operator[]
+	uint32_t allocate_range(uint32_t count) {
+		uint32_t offset = static_cast<uint32_t>(slots.size());
+		slots.resize(slots.size() + count);
+		return offset;
+	}
+
+	// takes over the free blocks of another pool whose slots were copied here starting at offset
+	void adopt_free_blocks(const ChildSlotPool& other, uint32_t offset) {
+		for (int cls = 0; cls < SIZE_CLASSES; ++cls) {
+			for (uint32_t block : other.free_blocks[cls]) free_blocks[cls].push_back(block + offset);
+		}
+	}
+
+	void clear() {
+		slots.clear();
+		for (std::vector<uint32_t>& free_list : free_blocks) free_list.clear();
+	}
+
+private:
+
+	std::vector<uint32_t> slots;
+	std::vector<uint32_t> free_blocks[SIZE_CLASSES];
+
+	static int size_class(uint32_t capacity) {
+		int cls = 0;
+		while ((1u << cls) < capacity) ++cls;
+		return cls;
+	}
+};
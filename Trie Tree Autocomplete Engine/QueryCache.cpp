@@ -0,0 +1,76 @@
+#include "QueryCache.h"
+#include <functional>
+
+QueryCache::QueryCache(size_t capacity) : capacity(capacity > 0 ? capacity : 1)
+{
+	index.reserve(this->capacity);
+}
+
+size_t QueryCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<std::string>()(key.query);
+	size_t rest = (static_cast<size_t>(key.k) << 8) ^ (static_cast<size_t>(key.max_edits) << 1) ^ static_cast<size_t>(key.kind);
+	return hash ^ (rest + 0x9e3779b9 + (hash << 6) + (hash >> 2)); // boost::hash_combine
+}
+
+QueryCache::Entry* QueryCache::find(const Key& key, uint64_t version)
+{
+	auto found = index.find(key);
+	if (found == index.end() || found->second->version != version) {
+		++misses;
+		return nullptr;
+	}
+
+	++hits;
+	entries.splice(entries.begin(), entries, found->second);
+	return &entries.front();
+}
+
+QueryCache::Entry& QueryCache::slot(const Key& key, uint64_t version)
+{
+	auto found = index.find(key);
+	if (found != index.end()) {
+		// a stale result for the same query, replaced where it is
+		entries.splice(entries.begin(), entries, found->second);
+	}
+	else {
+		if (entries.size() >= capacity) {
+			index.erase(entries.back().key);
+			entries.pop_back();
+		}
+		entries.push_front(Entry{ key, version, {}, {} });
+		index.emplace(key, entries.begin());
+	}
+
+	Entry& entry = entries.front();
+	entry.version = version;
+	return entry;
+}
+
+const std::vector<std::string>* QueryCache::find_prefix(const std::string& prefix, int k, uint64_t version)
+{
+	Entry* entry = find(Key{ Kind::PREFIX, prefix, k, 0 }, version);
+	return entry ? &entry->words : nullptr;
+}
+
+const std::vector<FuzzyMatch>* QueryCache::find_fuzzy(const std::string& input, int max_edits, int k, uint64_t version)
+{
+	Entry* entry = find(Key{ Kind::FUZZY, input, k, max_edits }, version);
+	return entry ? &entry->matches : nullptr;
+}
+
+void QueryCache::store_prefix(const std::string& prefix, int k, uint64_t version, const std::vector<std::string>& words)
+{
+	slot(Key{ Kind::PREFIX, prefix, k, 0 }, version).words = words;
+}
+
+void QueryCache::store_fuzzy(const std::string& input, int max_edits, int k, uint64_t version, const std::vector<FuzzyMatch>& matches)
+{
+	slot(Key{ Kind::FUZZY, input, k, max_edits }, version).matches = matches;
+}
+
+void QueryCache::clear()
+{
+	index.clear();
+	entries.clear();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <list>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "FuzzyMatch.h"
+
+
+// Bounded LRU cache of completion results, for the few prefixes that get typed over and over.
+// Entries are keyed by (query, k, max_edits) and stamped with the version they were computed on, normally the
+// version of the query's subtree (Trie::version(prefix), MappedDictionary::version(prefix)), so a selected word
+// only invalidates the queries it can affect. An entry of another version is a miss and gets overwritten in place
+// or evicted in turn, so an update costs the cache nothing when it happens.
+// A hit is one hash lookup and one list splice; the pointer it returns stays valid until the next store.
+// Not thread-safe, every thread that serves queries needs its own cache.
+class QueryCache {
+
+public:
+
+	explicit QueryCache(size_t capacity = 1024);
+
+	// nullptr when the result is not cached for this version
+	const std::vector<std::string>* find_prefix(const std::string& prefix, int k, uint64_t version);
+	const std::vector<FuzzyMatch>* find_fuzzy(const std::string& input, int max_edits, int k, uint64_t version);
+
+	void store_prefix(const std::string& prefix, int k, uint64_t version, const std::vector<std::string>& words);
+	void store_fuzzy(const std::string& input, int max_edits, int k, uint64_t version, const std::vector<FuzzyMatch>& matches);
+
+	void clear();
+
+	size_t size() const { return entries.size(); }
+	size_t get_hits() const { return hits; }
+	size_t get_misses() const { return misses; }
+
+private:
+
+	enum class Kind : uint8_t { PREFIX, FUZZY };
+
+	struct Key {
+		Kind kind;
+		std::string query;
+		int k;
+		int max_edits; // 0 for prefix queries
+
+		bool operator==(const Key& other) const {
+			return kind == other.kind && k == other.k && max_edits == other.max_edits && query == other.query;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+
+	struct Entry {
+		Key key;
+		uint64_t version;
+		std::vector<std::string> words;   // prefix queries
+		std::vector<FuzzyMatch> matches;  // fuzzy queries
+	};
+
+	size_t capacity;
+	std::list<Entry> entries; // most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+	size_t hits = 0;
+	size_t misses = 0;
+
+	// the current entry for key moved to the front, nullptr when it is missing or of another version
+	Entry* find(const Key& key, uint64_t version);
+
+	// the entry for key at the front, reused or evicting the least recently used one when full
+	Entry& slot(const Key& key, uint64_t version);
+};
@@ -0,0 +1,259 @@
+#include "RadixTrie.h"
+#include "Trie.h"
+#include <queue>
+#include <fstream>
+#include <algorithm>
+
+uint32_t RadixTrie::new_node(uint32_t label_offset, uint32_t label_length)
+{
+	uint32_t id = nodes.allocate();
+	nodes[id].label_offset = label_offset;
+	nodes[id].label_length = label_length;
+	return id;
+}
+
+void RadixTrie::insert(const std::string& raw_word, int freq)
+{
+	// same alphabet as Trie::insert, only small letters are kept
+	std::string word;
+	for (char ch : raw_word) {
+		if (std::islower(ch)) word.push_back(ch);
+	}
+
+	RadixNode* node = root;
+	size_t pos = 0;
+
+	while (pos < word.size()) {
+
+		size_t index = word[pos] - 'a';
+		RadixNode* next = child(node, index);
+
+		if (next == nullptr) {
+			// no edge starts with this letter, the whole remainder becomes one leaf edge
+			uint32_t label_offset = static_cast<uint32_t>(labels.size());
+			labels.append(word, pos, std::string::npos);
+			uint32_t leaf = new_node(label_offset, static_cast<uint32_t>(word.size() - pos));
+			child_slots.insert(node->child_mask, node->child_block, index, leaf);
+			node = &nodes[leaf];
+			break;
+		}
+
+		// how far the word follows this edge
+		uint32_t common = 0;
+		while (common < next->label_length && pos + common < word.size() && label_char(next, common) == word[pos + common]) {
+			++common;
+		}
+
+		if (common < next->label_length) {
+			// the word ends inside the edge or leaves it, split the edge so the shared part gets its own node
+			uint32_t next_id = child_slots.child_slot(node->child_mask, node->child_block, index);
+			uint32_t middle_id = new_node(next->label_offset, common);
+			RadixNode* middle = &nodes[middle_id];
+
+			next->label_offset += common;
+			next->label_length -= common;
+			child_slots.insert(middle->child_mask, middle->child_block, label_char(next, 0) - 'a', next_id);
+			child_slots.child_slot(node->child_mask, node->child_block, index) = middle_id;
+
+			next = middle;
+		}
+
+		node = next;
+		pos += common;
+	}
+
+	node->is_end_of_word = true;
+	node->frequency = freq;
+}
+
+void RadixTrie::log_selection(const std::string& word)
+{
+	RadixNode* node = root;
+	size_t pos = 0;
+
+	while (pos < word.size()) {
+		RadixNode* next = child(node, word[pos] - 'a');
+		if (!next) {
+			return;
+		}
+		// the whole edge has to match, a word ending inside an edge is not in the dictionary
+		if (next->label_length > word.size() - pos || labels.compare(next->label_offset, next->label_length, word, pos, next->label_length) != 0) {
+			return;
+		}
+		pos += next->label_length;
+		node = next;
+	}
+
+	if (node->is_end_of_word) {
+		node->frequency = node->frequency + Trie::SELECTION_BONUS;
+	}
+}
+
+std::vector<std::pair<std::string, int>> RadixTrie::get_words_with_prefix(const std::string& prefix) const
+{
+	std::vector<std::pair<std::string, int>> results;
+	RadixNode* node = root;
+	std::string current;
+	size_t pos = 0;
+
+	while (pos < prefix.size()) {
+		RadixNode* next = child(node, prefix[pos] - 'a');
+		if (!next) return results;
+
+		// the prefix may stop in the middle of an edge, then everything below that edge still matches
+		size_t compared = std::min<size_t>(next->label_length, prefix.size() - pos);
+		if (labels.compare(next->label_offset, compared, prefix, pos, compared) != 0) return results;
+
+		current.append(labels, next->label_offset, next->label_length);
+		pos += next->label_length;
+		node = next;
+	}
+
+	dfs(node, current, results);
+
+	return results;
+}
+
+void RadixTrie::dfs(RadixNode* node, std::string& current, std::vector<std::pair<std::string, int>>& results) const
+{
+	if (node->is_end_of_word) {
+		results.emplace_back(current, node->frequency);
+	}
+
+	// children are stored in letter order, so walking the dense block keeps the output sorted
+	int child_count = popcount32(node->child_mask);
+	for (int i = 0; i < child_count; ++i) {
+		RadixNode* next = child_at(node, i);
+		size_t length = current.size();
+		current.append(labels, next->label_offset, next->label_length);
+		dfs(next, current, results);
+		current.resize(length);
+	}
+}
+
+std::vector<std::string> RadixTrie::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	std::vector<std::pair<std::string, int>> all_words = get_words_with_prefix(prefix);
+
+	auto cmp = [](const auto& a, const auto& b) {
+		// max heap based on frequency
+		return a.second < b.second || (a.second == b.second && a.first > b.first);
+		};
+
+	std::priority_queue <
+		std::pair<std::string, int>,
+		std::vector<std::pair<std::string, int>>,
+		decltype(cmp)
+	> pq(cmp, all_words);
+
+	std::vector<std::string> result;
+	for (int i = 0; i < k && !pq.empty(); i++) {
+		result.push_back(pq.top().first);
+		pq.pop();
+	}
+	return result;
+}
+
+std::vector<FuzzyMatch> RadixTrie::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
+{
+	std::vector<FuzzyMatch> all_matches = get_ranked_fuzzy_matches(input, max_edits);
+
+	std::vector<std::string> words_with_prefix = this->get_top_k_with_prefix(input, k);
+	keep_prefix_matches(all_matches, words_with_prefix, k);
+
+	return all_matches;
+}
+
+std::vector<FuzzyMatch> RadixTrie::get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha) const
+{
+	// row[i] = Levenshtein distance between the path spelled so far and input[0, i)
+	// for the empty path that is simply i deletions
+	std::vector<int> row(input.size() + 1);
+	for (size_t i = 0; i < row.size(); ++i) {
+		row[i] = static_cast<int>(i);
+	}
+
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	std::string current;
+	search_fuzzy(root, input, current, row, max_edits, result_map);
+
+	return rank_fuzzy_matches(result_map, alpha);
+}
+
+void RadixTrie::search_fuzzy(RadixNode* node, const std::string& target, std::string& current, const std::vector<int>& row, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// every path is visited once, so the distance in the last cell is already the minimal edit distance of the word
+	if (node->is_end_of_word && row.back() <= max_edits) {
+		results[current] = FuzzyMatch{ current, node->frequency, row.back() };
+	}
+
+	std::vector<int> previous(row.size());
+	std::vector<int> next_row(row.size());
+
+	int child_count = popcount32(node->child_mask);
+	for (int c = 0; c < child_count; ++c) {
+		RadixNode* next = child_at(node, c);
+		size_t length = current.size();
+		previous = row;
+		bool within_budget = true;
+
+		// extend the DP table by one row per character of the edge label
+		for (uint32_t l = 0; l < next->label_length; ++l) {
+			char ch = label_char(next, l);
+			next_row[0] = previous[0] + 1;
+			int row_min = next_row[0];
+			for (size_t i = 1; i < row.size(); ++i) {
+				int substitution = previous[i - 1] + (target[i - 1] == ch ? 0 : 1);
+				int insertion = previous[i] + 1;
+				int deletion = next_row[i - 1] + 1;
+				next_row[i] = std::min(substitution, std::min(insertion, deletion));
+				row_min = std::min(row_min, next_row[i]);
+			}
+			current.push_back(ch);
+			previous.swap(next_row);
+
+			// no cell within budget means no word below can come back under it
+			if (row_min > max_edits) {
+				within_budget = false;
+				break;
+			}
+		}
+
+		if (within_budget) {
+			search_fuzzy(next, target, current, previous, max_edits, results);
+		}
+		current.resize(length);
+	}
+}
+
+void RadixTrie::load_from_file(const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in) {
+		std::cerr << "No saved data found (" << filename << ").\n";
+		return;
+	}
+
+	std::string word;
+	int freq;
+	while (in >> word >> freq) {
+		insert(word, freq);
+	}
+}
+
+void RadixTrie::save_to_file(const std::string& filename) const
+{
+	std::ofstream out(filename);
+	if (!out) {
+		std::cerr << "Failed to open file for saving.\n";
+		return;
+	}
+
+	std::vector<std::pair<std::string, int>> words;
+	std::string current;
+	dfs(root, current, words);
+
+	for (const std::pair<std::string, int>& pair : words) {
+		out << pair.first << ' ' << pair.second << '\n';
+	}
+}
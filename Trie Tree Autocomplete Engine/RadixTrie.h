@@ -0,0 +1,81 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "NodePool.h"
+#include "FuzzyMatch.h"
+
+
+// Path-compressed (radix / Patricia) variant of Trie.
+// Runs of single-child nodes are collapsed into one edge whose label is a slice of a shared character pool,
+// so a long identifier costs one node per branching point instead of one node per character.
+// It exposes the same insert / learning / query / persistence API as Trie and produces the same results.
+class RadixTrie {
+
+private:
+
+	class RadixNode {
+
+	public:
+
+		// children are keyed by the first letter of their edge label and stored the same sparse way as in Trie
+		uint32_t child_mask;
+		uint32_t child_block;
+
+		// label of the edge leading into this node = labels[label_offset, label_offset + label_length)
+		uint32_t label_offset;
+		uint32_t label_length;
+
+		int frequency = 0;
+		bool is_end_of_word;
+
+		RadixNode() : child_mask(0), child_block(0), label_offset(0), label_length(0), is_end_of_word(false) {}
+
+	};
+
+	NodePool<RadixNode> nodes;
+	ChildSlotPool child_slots;
+	std::string labels; // character pool every edge label points into, splitting an edge never copies characters
+	RadixNode* root;
+
+	RadixNode* child(const RadixNode* node, size_t index) const {
+		if (index >= 26 || !((node->child_mask >> index) & 1u)) return nullptr;
+		return const_cast<RadixNode*>(&nodes[child_slots.child_slot(node->child_mask, node->child_block, index)]);
+	}
+
+	// i-th child in letter order, i < popcount(child_mask)
+	RadixNode* child_at(const RadixNode* node, int i) const {
+		return const_cast<RadixNode*>(&nodes[child_slots[node->child_block + i]]);
+	}
+
+	char label_char(const RadixNode* node, uint32_t i) const { return labels[node->label_offset + i]; }
+
+public:
+
+	RadixTrie() { root = &nodes[nodes.allocate()]; }
+
+	void insert(const std::string& word, int freq = 1);
+	void log_selection(const std::string& word);
+
+	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
+
+	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	size_t node_count() const { return nodes.size(); }
+	size_t memory_usage() const { return nodes.memory_usage() + child_slots.memory_usage() + labels.capacity(); }
+
+	void save_to_file(const std::string& filename) const;
+	void load_from_file(const std::string& filename);
+
+private:
+
+	uint32_t new_node(uint32_t label_offset, uint32_t label_length);
+
+	std::vector<std::pair<std::string, int>> get_words_with_prefix(const std::string& prefix) const;
+	void dfs(RadixNode* node, std::string& current, std::vector<std::pair<std::string, int>>& results) const;
+
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
+	void search_fuzzy(RadixNode* node, const std::string& target, std::string& current, const std::vector<int>& row, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+};
@@ -0,0 +1,107 @@
+#include "SuccinctBitVector.h"
+#include "BitUtils.h"
+
+void SuccinctBitVector::push_back(bool bit)
+{
+	if ((bit_count & 63) == 0) {
+		words.push_back(0);
+	}
+	if (bit) {
+		words.back() |= uint64_t(1) << (bit_count & 63);
+	}
+	++bit_count;
+}
+
+void SuccinctBitVector::build_index()
+{
+	block_ranks.clear();
+	block_ranks.reserve(words.size() / WORDS_PER_BLOCK + 1);
+
+	size_t running = 0;
+	for (size_t w = 0; w < words.size(); ++w) {
+		if (w % WORDS_PER_BLOCK == 0) {
+			block_ranks.push_back(static_cast<uint32_t>(running));
+		}
+		running += popcount64(words[w]);
+	}
+	one_count = running;
+}
+
+size_t SuccinctBitVector::rank1(size_t i) const
+{
+	size_t word = i >> 6;
+	size_t block = word / WORDS_PER_BLOCK;
+	size_t rank = block < block_ranks.size() ? block_ranks[block] : one_count;
+
+	for (size_t w = block * WORDS_PER_BLOCK; w < word; ++w) {
+		rank += popcount64(words[w]);
+	}
+	if ((i & 63) != 0) {
+		rank += popcount64(words[word] & ((uint64_t(1) << (i & 63)) - 1));
+	}
+	return rank;
+}
+
+size_t SuccinctBitVector::select_in_word(uint64_t word, size_t k)
+{
+	// k-th (from 1) set bit of a single word
+	for (size_t bit = 0; bit < 64; bit += 8) {
+		size_t byte_ones = popcount64((word >> bit) & 0xFF);
+		if (k <= byte_ones) {
+			for (size_t b = bit; ; ++b) {
+				if ((word >> b) & 1u) {
+					if (--k == 0) return b;
+				}
+			}
+		}
+		k -= byte_ones;
+	}
+	return 64;
+}
+
+size_t SuccinctBitVector::select1(size_t k) const
+{
+	// last block whose preceding count is still below k
+	size_t low = 0;
+	size_t high = block_ranks.size();
+	while (high - low > 1) {
+		size_t middle = (low + high) / 2;
+		if (block_ranks[middle] < k) low = middle;
+		else high = middle;
+	}
+
+	size_t remaining = k - block_ranks[low];
+	for (size_t w = low * WORDS_PER_BLOCK; w < words.size(); ++w) {
+		size_t word_ones = popcount64(words[w]);
+		if (remaining <= word_ones) {
+			return (w << 6) + select_in_word(words[w], remaining);
+		}
+		remaining -= word_ones;
+	}
+	return bit_count;
+}
+
+size_t SuccinctBitVector::select0(size_t k) const
+{
+	// same search over the complemented counts; bits past the end are never counted as zeros
+	size_t low = 0;
+	size_t high = block_ranks.size();
+	while (high - low > 1) {
+		size_t middle = (low + high) / 2;
+		if (middle * WORDS_PER_BLOCK * 64 - block_ranks[middle] < k) low = middle;
+		else high = middle;
+	}
+
+	size_t remaining = k - (low * WORDS_PER_BLOCK * 64 - block_ranks[low]);
+	for (size_t w = low * WORDS_PER_BLOCK; w < words.size(); ++w) {
+		uint64_t zeros = ~words[w];
+		size_t valid = bit_count - (w << 6);
+		if (valid < 64) zeros &= (uint64_t(1) << valid) - 1;
+		size_t word_zeros = popcount64(zeros);
+		if (remaining <= word_zeros) {
+			return (w << 6) + select_in_word(zeros, remaining);
+		}
+		remaining -= word_zeros;
+	}
+	return bit_count;
+}
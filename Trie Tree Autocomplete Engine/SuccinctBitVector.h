@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+// Append-only bit vector with constant-time rank and logarithmic-time select.
+// The rank directory stores one absolute count per 256-bit block (12.5% overhead on top of the bits),
+// a rank inside a block adds the popcounts of at most three whole words plus a masked one.
+// select binary-searches the block counts and finishes with a word scan.
+class SuccinctBitVector {
+
+public:
+
+	void push_back(bool bit);
+
+	// must be called once after the last push_back and before any rank/select query
+	void build_index();
+
+	bool get(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+	size_t size() const { return bit_count; }
+	size_t ones() const { return one_count; }
+
+	// number of set bits in [0, i)
+	size_t rank1(size_t i) const;
+	size_t rank0(size_t i) const { return i - rank1(i); }
+
+	// position of the k-th set / clear bit, k counted from 1
+	size_t select1(size_t k) const;
+	size_t select0(size_t k) const;
+
+	size_t memory_usage() const { return words.capacity() * sizeof(uint64_t) + block_ranks.capacity() * sizeof(uint32_t); }
+
+private:
+
+	static constexpr size_t WORDS_PER_BLOCK = 4; // 256 bits
+
+	std::vector<uint64_t> words;
+	std::vector<uint32_t> block_ranks; // set bits before each block
+	size_t bit_count = 0;
+	size_t one_count = 0;
+
+	static size_t select_in_word(uint64_t word, size_t k);
+};
@@ -0,0 +1,119 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	for (unsigned i = 0; i < threads; ++i) {
+		queues.emplace_back(new WorkQueue());
+	}
+	for (unsigned i = 0; i < threads; ++i) {
+		workers.emplace_back(&ThreadPool::worker_loop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	push(next_queue++ % queues.size(), std::move(task));
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0) return;
+
+	// shared with the tasks, the last one may still be notifying after the caller saw the count reach zero
+	struct Batch {
+		std::atomic<size_t> remaining;
+		std::mutex mutex;
+		std::condition_variable done;
+	};
+	std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+	batch->remaining = count;
+
+	size_t first = next_queue++;
+	for (size_t i = 0; i < count; ++i) {
+		push((first + i) % queues.size(), [batch, &task, i]() {
+			task(i);
+			if (--batch->remaining == 0) {
+				std::lock_guard<std::mutex> lock(batch->mutex);
+				batch->done.notify_all();
+			}
+		});
+	}
+
+	// help instead of blocking a thread, then wait for the tasks other threads are still running
+	size_t home = first % queues.size();
+	while (batch->remaining > 0) {
+		if (run_one(home)) continue;
+
+		std::unique_lock<std::mutex> lock(batch->mutex);
+		batch->done.wait(lock, [&batch]() { return batch->remaining == 0; });
+	}
+}
+
+void ThreadPool::push(size_t queue, std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+		queues[queue]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		++queued;
+	}
+	wake.notify_one();
+}
+
+bool ThreadPool::run_one(size_t home)
+{
+	std::function<void()> task;
+
+	{
+		WorkQueue& own = *queues[home];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+		}
+	}
+
+	// steal the oldest task of another queue, it is the one its owner would get to last
+	for (size_t i = 1; !task && i < queues.size(); ++i) {
+		WorkQueue& victim = *queues[(home + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+	}
+
+	if (!task) return false;
+	--queued;
+	task();
+	return true;
+}
+
+void ThreadPool::worker_loop(size_t index)
+{
+	while (true) {
+		if (run_one(index)) continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake.wait(lock, [this]() { return stopping || queued > 0; });
+		if (stopping && queued == 0) return;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads with work stealing.
+// Every worker owns a queue: it takes its own tasks from the back (the most recently pushed, still warm in cache)
+// and, once that is empty, steals from the front of the other queues, so uneven tasks spread themselves out
+// without a central queue every thread contends on.
+// parallel_for lets the calling thread work on its own batch while it waits, so it may be called from a task.
+class ThreadPool {
+
+public:
+
+	// threads = 0 starts one worker per hardware thread
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool(); // finishes the queued tasks, then joins the workers
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+	void submit(std::function<void()> task);
+
+	// runs task(0) .. task(count - 1) on the pool and returns when every one has finished
+	void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+private:
+
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue>> queues; // one per worker
+	std::vector<std::thread> workers;
+
+	std::atomic<size_t> next_queue{ 0 }; // round robin for tasks submitted from outside
+
+	// sleeping workers wait here until something is queued; queued is only raised under sleep_mutex,
+	// so a worker checking it under the same lock cannot miss the wake-up
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+	std::atomic<size_t> queued{ 0 };
+	bool stopping = false;
+
+	void push(size_t queue, std::function<void()> task);
+
+	// runs one task, from queue home first and then from the others; false when every queue was empty
+	bool run_one(size_t home);
+
+	void worker_loop(size_t index);
+};
@@ -1,63 +1,305 @@
 #include "Trie.h"
+#include "DoubleArrayTrie.h"
+#include "LevenshteinAutomaton.h"
+#include "MyersPattern.h"
+#include "MappedDictionary.h"
+#include "ThreadPool.h"
 #include <queue>
 #include <fstream>
 #include <unordered_set>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <cctype>
+#include <numeric>
+
+const int Trie::NO_WORDS;
+const int Trie::SELECTION_BONUS;
+const int Trie::PARALLEL_FUZZY_MIN_EDITS;
+
+namespace {
+
+	// words of one chunk of a text dictionary, bucketed by the first letter insert would store for them
+	// (that letter removed, it becomes the root of the letter's subtree) in the order they appear
+	struct ParsedChunk {
+		std::array<std::vector<std::pair<std::string, int>>, 26> words;
+		bool has_empty_word = false; // a word without any letter is stored at the root itself
+		int empty_word_frequency = 0;
+		bool malformed = false;      // parsing stopped at a line that is not "word frequency"
+	};
+
+	bool is_space(char ch)
+	{
+		return std::isspace(static_cast<unsigned char>(ch)) != 0;
+	}
+
+	// reads "word frequency" pairs like load_from_file's stream extraction, stopping at the first bad pair
+	void parse_chunk(const char* p, const char* end, ParsedChunk& out)
+	{
+		while (true) {
+			while (p != end && is_space(*p)) ++p;
+			if (p == end) return;
+
+			const char* word = p;
+			while (p != end && !is_space(*p)) ++p;
+			const char* word_end = p;
+
+			while (p != end && is_space(*p)) ++p;
+
+			// an int, optionally signed, rejected on overflow just like operator>> would
+			bool negative = p != end && *p == '-';
+			if (p != end && (*p == '-' || *p == '+')) ++p;
+			long long value = 0;
+			const char* digits = p;
+			while (p != end && *p >= '0' && *p <= '9' && value <= INT_MAX) {
+				value = value * 10 + (*p - '0');
+				++p;
+			}
+			if (negative) value = -value;
+			if (p == digits || (p != end && !is_space(*p)) || value > INT_MAX || value < INT_MIN) {
+				out.malformed = true;
+				return;
+			}
+
+			const char* first = std::find_if(word, word_end, [](char ch) { return std::islower(ch) != 0; });
+			if (first == word_end) {
+				out.has_empty_word = true;
+				out.empty_word_frequency = static_cast<int>(value);
+			}
+			else {
+				out.words[*first - 'a'].emplace_back(std::string(first + 1, word_end), static_cast<int>(value));
+			}
+		}
+	}
+
+	// runs task(0) .. task(tasks - 1) on up to threads threads, the calling thread included
+	template <typename Task>
+	void run_in_parallel(unsigned threads, size_t tasks, const Task& task)
+	{
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			for (size_t i = next++; i < tasks; i = next++) task(i);
+		};
+
+		std::vector<std::thread> workers;
+		for (unsigned t = 1; t < threads && t < tasks; ++t) workers.emplace_back(worker);
+		worker();
+		for (std::thread& thread : workers) thread.join();
+	}
+
+}
 
 void Trie::insert(const std::string& word, int freq)
 {
-	TrieNode* node = root.get();
+	++dictionary_version;
+
+	TrieNode* node = root;
+	std::vector<TrieNode*> path{ root };
+	std::string stored; // the word as it ends up in the trie, only needed by the deletion index
 
 	for (char ch : word) {
 
 		if (!std::islower(ch)) continue; // allow only small letters
 
+		if (deletion_index) stored.push_back(ch);
+
 		size_t index = ch - 'a';
 
-		if (node->children[index] == nullptr) {
-			node->children[index] = std::make_unique<TrieNode>();
+		TrieNode* next = child(node, index);
+		if (next == nullptr) {
+			// new nodes come from the current slab, no per-node heap allocation
+			next = add_child(node, index);
 		}
-		node = node->children[index].get();
+		node = next;
+		path.push_back(node);
+	}
+
+	if (deletion_index && !node->is_end_of_word) {
+		deletion_index->add(stored);
 	}
 
 	node->is_end_of_word = true;
 	node->frequency = freq;
 
+	// the new frequency may raise or (when overwriting a word) lower the maxima along the path
+	update_max_frequency(path);
+
+	for (TrieNode* changed : path) {
+		changed->version = dictionary_version;
+	}
+
+}
+
+Trie::SortedBuilder::SortedBuilder(Trie& trie) : trie(trie), path{ trie.root }
+{
+	if (!trie.empty()) {
+		std::cerr << "SortedBuilder needs an empty trie, adding nothing.\n";
+		finished = true;
+		return;
+	}
+
+	// every node added from here on is stamped with this version when it is created
+	trie.root->version = ++trie.dictionary_version;
+}
+
+bool Trie::SortedBuilder::add(const std::string& word, int freq)
+{
+	if (finished) return false;
+
+	std::string& stored = scratch; // reused, together with previous, so no word allocates
+	stored.clear();
+	for (char ch : word) {
+		if (std::islower(ch)) stored.push_back(ch); // same filter as insert
+	}
+
+	if (stored < previous) return false; // previous starts out empty, which sorts first
+
+	size_t common = 0;
+	while (common < stored.size() && common < previous.size() && stored[common] == previous[common]) ++common;
+
+	// the previous word's nodes below the shared prefix can no longer gain children
+	close_below(common);
+
+	// every remaining letter sorts after the existing children of its parent, so it becomes the last child
+	for (size_t i = common; i < stored.size(); ++i) {
+		path.push_back(trie.add_child(path.back(), stored[i] - 'a'));
+	}
+
+	TrieNode* node = path.back();
+	if (trie.deletion_index && !node->is_end_of_word) {
+		trie.deletion_index->add(stored);
+	}
+	node->is_end_of_word = true;
+	node->frequency = freq; // a repeated word keeps the last frequency, as with insert
+
+	previous.swap(stored);
+	return true;
+}
+
+void Trie::SortedBuilder::close_below(size_t depth)
+{
+	while (path.size() > depth + 1) {
+		path.back()->max_frequency = trie.subtree_max_frequency(path.back());
+		path.pop_back();
+	}
+}
+
+void Trie::SortedBuilder::finish()
+{
+	if (finished) return;
+	close_below(0);
+	trie.root->max_frequency = trie.subtree_max_frequency(trie.root);
+	finished = true;
+}
+
+Trie::TrieNode* Trie::add_child(TrieNode* node, size_t index)
+{
+	uint32_t id = nodes.allocate();
+	child_slots.insert(node->child_mask, node->child_block, index, id);
+	nodes[id].version = dictionary_version;
+	return &nodes[id];
+}
+
+Trie::TrieNode* Trie::find_node(const std::string& word) const
+{
+	TrieNode* node = root;
+	for (char ch : word) {
+		node = child(node, ch - 'a');
+		if (!node) return nullptr;
+	}
+	return node;
+}
+
+uint64_t Trie::version(const std::string& prefix) const
+{
+	// a missing prefix has no results until a word is added below the deepest node it has, which stamps that node
+	const TrieNode* node = root;
+	for (char ch : prefix) {
+		const TrieNode* next = child(node, ch - 'a');
+		if (!next) break;
+		node = next;
+	}
+	return node->version;
 }
 
 void Trie::log_selection(const std::string& word)
 {
-	TrieNode* node = root.get();
+	add_frequency(word, SELECTION_BONUS);
+}
+
+void Trie::add_frequency(const std::string& word, int delta)
+{
+	TrieNode* node = root;
+	std::vector<TrieNode*> path{ root };
 
 	for (char ch : word) {
 		size_t index = ch - 'a';
-		if (!node->children[index]) {
+		TrieNode* next = child(node, index);
+		if (!next) {
 			return;
 		}
-		node = node->children[index].get();
+		node = next;
+		path.push_back(node);
 	}
 
 	if (node->is_end_of_word) {
-		node->frequency = node->frequency + 5;
+		node->frequency = node->frequency + delta;
+
+		++dictionary_version;
+		for (TrieNode* changed : path) {
+			changed->version = dictionary_version;
+		}
+
+		if (delta >= 0) {
+			// the frequency only grew, so the path maxima can only grow as well
+			for (TrieNode* ancestor : path) {
+				ancestor->max_frequency = std::max(ancestor->max_frequency, node->frequency);
+			}
+		}
+		else {
+			update_max_frequency(path);
+		}
 	}
 
 }
 
+int Trie::subtree_max_frequency(const TrieNode* node) const
+{
+	int best = node->is_end_of_word ? node->frequency : NO_WORDS;
+	int child_count = popcount32(node->child_mask);
+	for (int i = 0; i < child_count; ++i) {
+		best = std::max(best, nodes[child_slots[node->child_block + i]].max_frequency);
+	}
+	return best;
+}
+
+void Trie::update_max_frequency(const std::vector<TrieNode*>& path)
+{
+	// recompute bottom-up, an ancestor cannot change once one of its descendants on the path did not
+	for (size_t i = path.size(); i-- > 0;) {
+		int updated = subtree_max_frequency(path[i]);
+		if (updated == path[i]->max_frequency && i + 1 < path.size()) break;
+		path[i]->max_frequency = updated;
+	}
+}
+
 void Trie::debug_print() const
 {
 	std::string current;
-	debug_print_recursive(root.get(), current, 0);
+	debug_print_recursive(root, current, 0);
 }
 
 std::vector<std::pair<std::string, int>> Trie::get_words_with_prefix(const std::string& prefix) const 
 {
 	std::vector<std::pair<std::string, int>> results;
-	TrieNode* node = this->root.get();
+	TrieNode* node = this->root;
 
 	for (char ch : prefix) {
 	
 		size_t index = ch - 'a';
-		if (!node->children[index]) return results;
-		node = node->children[index].get();
+		node = child(node, index);
+		if (!node) return results;
 
 	}
 
@@ -69,65 +311,215 @@ std::vector<std::pair<std::string, int>> Trie::get_words_with_prefix(const std::
 
 std::vector<FuzzyMatch> Trie::get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const
 {
-	std::vector<FuzzyMatch> all_matches = get_ranked_fuzzy_matches(input, max_edits);
-
-	/*
-	std::cout << "\n--- All Fuzzy Matches for input '" << input << "' (before sorting) ---\n";
-	for (const auto& m : all_matches) {
-		std::cout << "Word: " << m.word
-			<< ", Freq: " << m.frequency
-			<< ", Dist: " << m.edit_distance
-			<< ", Score: " << m.score << "\n";
-	}
-	std::cout << "--------------------------------------------------------\n";
-	// --- END DEBUG PRINTS ---
-	*/
-	std::vector<std::string> words_with_prefix = this->get_top_k_with_prefix(input, k);
-	std::unordered_set<std::string> prefix_words_set(words_with_prefix.begin(), words_with_prefix.end());
-	//this->prefix_checking(matches, prefix_words_set);
-	
-	for (int i = 0; i < all_matches.size(); /* no i++ here */) { // Note: no i++ in the loop header
-		bool found_in_prefix = false;
-		if (prefix_words_set.count(all_matches[i].word)) { // count returns 1 if found, 0 if not
-			found_in_prefix = true;
-			all_matches[i].score = all_matches[i].score + 10;
+	// only fuzzy matches that are also top prefix completions are kept, so the result follows from the
+	// completions alone, exactly as the batch and the CompletionSession answer it
+	return fuzzy_matches_from_completions(input, this->get_top_k_with_prefix(input, k), max_edits, k);
+}
+
+std::vector<FuzzyMatch> Trie::get_ranked_fuzzy_matches_parallel(const std::string& input, int max_edits, double alpha) const
+{
+	// one task per letter, plus one for the word without letters stored in root; the subtrees hold different
+	// words, so the matches of all tasks together are the matches of one search over the whole trie
+	std::vector<std::unordered_map<std::string, FuzzyMatch>> local(26 + 1);
+	fuzzy_pool->parallel_for(local.size(), [&](size_t index) {
+		if (index < 26) {
+			if (has_child(root, index)) search_fuzzy_subtree(index, input, max_edits, local[index]);
 		}
-		if (!found_in_prefix) {
-			all_matches.erase(all_matches.begin() + i);
+		else if (root->is_end_of_word && static_cast<int>(input.size()) <= max_edits) {
+			// reached from the input by deleting all of it
+			local[index][""] = FuzzyMatch{ "", root->frequency, static_cast<int>(input.size()) };
 		}
-		else {
-			i++;
+	});
+
+	std::unordered_map<std::string, FuzzyMatch> result_map;
+	for (std::unordered_map<std::string, FuzzyMatch>& matches : local) {
+		result_map.insert(matches.begin(), matches.end());
+	}
+	return rank_fuzzy_matches(result_map, alpha);
+}
+
+void Trie::search_fuzzy_subtree(size_t index, const std::string& input, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// the configured engine, started on the root's child for letter index instead of on root
+	TrieNode* node = child(root, index);
+	char ch = static_cast<char>('a' + index);
+	std::string current(1, ch);
+
+	switch (fuzzy_engine) {
+	case FuzzyEngine::AUTOMATON: {
+		// the automaton interns its states as it runs, so every task needs its own
+		LevenshteinAutomaton automaton(input, max_edits);
+		int state = automaton.step(automaton.start(), ch);
+		if (state != LevenshteinAutomaton::DEAD) {
+			search_fuzzy_automaton(node, automaton, state, current, results);
+		}
+		break;
+	}
+	case FuzzyEngine::BIT_PARALLEL:
+		if (input.size() <= MyersPattern::MAX_LENGTH) {
+			MyersPattern pattern(input);
+			MyersState state = pattern.step(pattern.start(), ch);
+			if (pattern.lower_bound(state, 1) <= max_edits) {
+				search_fuzzy_bit_parallel(node, pattern, state, current, max_edits, results);
+			}
+			break;
+		}
+		// fall through - longer inputs do not fit in one machine word, use the DP rows
+	case FuzzyEngine::DP_ROWS:
+	default: {
+		// the rows for the empty path and for the first letter, search_fuzzy continues from the second
+		const size_t width = input.size() + 1;
+		std::vector<int> rows(2 * width);
+		for (size_t j = 0; j < width; ++j) {
+			rows[j] = static_cast<int>(j);
+		}
+		rows[width] = 1;
+		int row_min = rows[width];
+		for (size_t j = 1; j < width; ++j) {
+			int substitution = rows[j - 1] + (input[j - 1] == ch ? 0 : 1);
+			rows[width + j] = std::min(substitution, std::min(rows[j] + 1, rows[width + j - 1] + 1));
+			row_min = std::min(row_min, rows[width + j]);
 		}
+		if (row_min <= max_edits) {
+			search_fuzzy(node, input, current, rows, max_edits, results);
+		}
+		break;
+	}
 	}
+}
+
+std::vector<std::string> Trie::get_top_k_with_prefix(const std::string& prefix, int k) const
+{
+	TrieNode* node = find_node(prefix);
+	if (!node) return std::vector<std::string>();
+	return get_top_k_below(node, prefix, k);
+}
+
+std::vector<FuzzyMatch> Trie::fuzzy_matches_from_completions(const std::string& input, const std::vector<std::string>& completions, int max_edits, int k) const
+{
+	std::vector<FuzzyMatch> matches;
+	for (const std::string& completion : completions) {
+		int distance = static_cast<int>(completion.size() - input.size());
+		if (distance > max_edits) continue;
 
-	if ((int)all_matches.size() > k) {
-		all_matches.resize(k); // keep only top k
+		// scored as rank_fuzzy_matches and then keep_prefix_matches would
+		FuzzyMatch match{ completion, find_node(completion)->frequency, distance, 0 };
+		match.score = match.frequency - 1.0 * match.edit_distance + 10;
+		matches.push_back(match);
 	}
 
-	return all_matches;
+	std::sort(matches.begin(), matches.end());
+	if ((int)matches.size() > k) {
+		matches.resize(k);
+	}
+	return matches;
 }
 
-std::vector<std::string> Trie::get_top_k_with_prefix(const std::string& prefix, int k) const
+std::vector<size_t> Trie::find_batch_nodes(const std::vector<std::string>& queries, std::vector<const TrieNode*>& nodes) const
 {
-	
-	std::vector<std::pair<std::string, int>> all_words = get_words_with_prefix(prefix);
+	std::vector<size_t> order(queries.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return queries[a] < queries[b]; });
 
-	auto cmp = [](const auto& a, const auto& b) {
-		// max heap based on frequeyncy
-		return a.second < b.second || (a.second == b.second && a.first > b.first);
-		};
+	// path[d] is the node of the first d letters of the previous query, as far as it is in the trie;
+	// the next query keeps the part it shares and walks on from there
+	std::vector<const TrieNode*> path{ root };
+	const std::string* previous = nullptr;
+	nodes.assign(queries.size(), nullptr);
 
-	std::priority_queue <
-		std::pair<std::string, int>,
-		std::vector<std::pair<std::string, int>>,
-		decltype(cmp)
-	> pq(cmp, all_words);
+	for (size_t position : order) {
+		const std::string& query = queries[position];
 
+		size_t common = 0;
+		if (previous) {
+			while (common < query.size() && common < previous->size() && query[common] == (*previous)[common]) ++common;
+		}
+		if (path.size() > common + 1) path.resize(common + 1);
+
+		while (path.size() <= query.size()) {
+			const TrieNode* next = child(path.back(), query[path.size() - 1] - 'a');
+			if (!next) break;
+			path.push_back(next);
+		}
+
+		if (path.size() == query.size() + 1) nodes[position] = path.back();
+		previous = &query;
+	}
+	return order;
+}
+
+std::vector<std::vector<std::string>> Trie::get_top_k_with_prefix_batch(const std::vector<std::string>& prefixes, int k) const
+{
+	std::vector<const TrieNode*> nodes;
+	std::vector<size_t> order = find_batch_nodes(prefixes, nodes);
+
+	std::vector<std::vector<std::string>> results(prefixes.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		size_t position = order[i];
+		if (i > 0 && prefixes[order[i - 1]] == prefixes[position]) {
+			results[position] = results[order[i - 1]]; // same prefix, already answered
+		}
+		else if (nodes[position]) {
+			results[position] = get_top_k_below(nodes[position], prefixes[position], k);
+		}
+	}
+	return results;
+}
+
+std::vector<std::vector<FuzzyMatch>> Trie::get_top_k_fuzzy_matches_batch(const std::vector<std::string>& inputs, int max_edits, int k) const
+{
+	std::vector<std::vector<std::string>> completions = get_top_k_with_prefix_batch(inputs, k);
+
+	std::vector<std::vector<FuzzyMatch>> results(inputs.size());
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		results[i] = fuzzy_matches_from_completions(inputs[i], completions[i], max_edits, k);
+	}
+	return results;
+}
+
+std::vector<std::string> Trie::get_top_k_below(const TrieNode* node, const std::string& prefix, int k) const
+{
+	// best-first branch and bound over subtree maxima
+	// a queued node stands for every word below it and is ranked by its best possible frequency,
+	// a queued word is ranked by its actual frequency; popping in (value desc, text asc) order yields
+	// the words in the same order as sorting the whole subtree by frequency, then alphabetically,
+	// but only the nodes on the way to the k winners (and their siblings) are ever touched
 	std::vector<std::string> result;
-	for (int i = 0; i < k && !pq.empty(); i++) {
-		result.push_back(pq.top().first);
+	if (k <= 0 || node->max_frequency == NO_WORDS) return result;
+
+	struct Candidate {
+		int value;
+		std::string text;
+		const TrieNode* node; // nullptr for a finished word
+	};
+
+	auto cmp = [](const Candidate& a, const Candidate& b) {
+		return a.value < b.value || (a.value == b.value && a.text > b.text);
+		};
+
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(cmp)> pq(cmp);
+	pq.push(Candidate{ node->max_frequency, prefix, node });
+
+	while (!pq.empty() && (int)result.size() < k) {
+		Candidate top = pq.top();
 		pq.pop();
+
+		if (top.node == nullptr) {
+			result.push_back(top.text);
+			continue;
+		}
+
+		if (top.node->is_end_of_word) {
+			pq.push(Candidate{ top.node->frequency, top.text, nullptr });
+		}
+		for (char ch = 'a'; ch <= 'z'; ++ch) {
+			TrieNode* next = child(top.node, ch - 'a');
+			if (next) {
+				pq.push(Candidate{ next->max_frequency, top.text + ch, next });
+			}
+		}
 	}
+
 	return result;
 }
 
@@ -139,9 +531,9 @@ void Trie::dfs(TrieNode* node, std::string& current, std::vector<std::pair<std::
 
 	for (char ch = 'a'; ch <= 'z'; ++ch) {
 		size_t index = ch - 'a';
-		if (node->children[index]) {
+		if (has_child(node, index)) {
 			current.push_back(ch);
-			dfs(node->children[index].get(), current, results);
+			dfs(child(node, index), current, results);
 			current.pop_back();
 		}
 	}
@@ -168,104 +560,129 @@ std::vector<FuzzyMatch> Trie::get_fuzzy_matches(const std::string& input, int ma
 }
 */
 
-void Trie::search_fuzzy(TrieNode* node, const std::string& target, std::string& current, int index, int edits_remaining, std::unordered_map<std::string, FuzzyMatch>& results, int edits_used) const
-{
-	// recursive helper for fuzzy search
-	// recursivly explore all valid paths in the Trie thad could potentially form a fuzzy match to target with the given edits_remaining limit
-	// explores all possible paths in the Trie, corresponding to different combinations of edits, while keeping edits_remaining count updated
-	// each recursive call needs to know:
-	// 1) where are we in Trie currently during DFS = node
-	// 2) what target string we are trying to match (original user input string) = target
-	// 3) what word is being built up along the current path in the Trie = current
-	// 4) what character we are currently trying to match in the target string = index
-	// 5) how many edits are we still allowed to make to transform target into word found in the Trie (when zero search stops) = edits_remaining
-	// 6) variable to store found matches = results;
-
-	// [1] Base cases / Pruning
-	// If we hit a null node (meaning this path doesn't exist in the Trie)
-	// Or if we've used up all our allowed edits (edits_remaining becomes negative)
-	// then this path cannot lead to a valid match. Stop exploring.
-	if (!node || edits_remaining < 0) return;
-
-	// [2] End of Target String (Base Case for Target Index) ---
-	// This block is executed when we have processed all characters of the 'target' string.
-	// At this point, 'index' has reached the length of the 'target' string
-	if (index == target.size()) {
-		if (node->is_end_of_word && edits_remaining >= 0) {
-			auto it = results.find(current);
-			if (it == results.end() || it->second.edit_distance > edits_used) {
-				results[current] = FuzzyMatch{ current, node->frequency, edits_used };
-			}
-		}
-		// Allow extra insertions at the end
-		// This part handles cases where the target string might be a prefix of a word in the Trie,
-		// and the remaining characters in the Trie word are "insertions" relative to the target.
-		// Example: target="cat", max_edits=1. Trie has "cats".
-		// When index == target.size() (after 't' in target 'cat'), we are at Trie node for 't'.
-		// We can then "insert" 's' (if edits_remaining > 0) to match "cats".
-		for (char ch = 'a'; ch <= 'z'; ++ch) {
-			int i = ch - 'a';
-			if (node->children[i]) { // If there's a child for this character in the Trie
-				current.push_back(ch); // Add the Trie char to our current_word_path
-				// Recurse: Move to the child node, but 'index' (target position) remains the same
-				// as we are simulating an *insertion* into the target (i.e., we are consuming an edit
-				// without advancing in the target string)
-				search_fuzzy(node->children[i].get(), target, current, index, edits_remaining - 1, results, edits_used + 1);
-				current.pop_back(); // backtrack
-			}
-		}
-		return;
-	}
+void Trie::search_fuzzy(TrieNode* node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// Levenshtein DP carried down the trie, one row per depth
+	// rows holds the rows back to back; the row at depth d = current.size() stores, for every i,
+	// the edit distance between current (the path spelled so far) and target[0, i)
+	// each (node, index) state is computed exactly once, so the cost is nodes visited x target length
+	// 1) what target string we are trying to match (original user input string) = target
+	// 2) what word is being built up along the current path in the Trie = current
+	// 3) how many edits we allow between target and a word found in the Trie = max_edits
 
-	// [3] General Recursive Step
-	// This is the core recursive logic that explores the four edit possibilities: Match, Substitution, Insertion, Deletion
+	const size_t width = target.size() + 1;
+	const size_t row = current.size() * width;
+	const size_t next_row = row + width;
 
-	char target_ch = target[index]; // Get the current character from the target string
+	// [1] the last cell is the distance between target and the word ending here, exact and minimal
+	if (node->is_end_of_word && rows[row + width - 1] <= max_edits) {
+		results[current] = FuzzyMatch{ current, node->frequency, rows[row + width - 1] };
+	}
 
-	// Explore all 26 possible next characters in Trie;
-	// This loop explores 'Match' and 'Substitution' possibilities by comparing
-	// It als handles 'Insertion' from the perspective of the Trie (skipping the target character)
+	if (rows.size() < next_row + width) {
+		rows.resize(next_row + width);
+	}
+
+	// [2] extend the table by the row of every child
 	for (char ch = 'a'; ch <= 'z'; ++ch) {
 		int i = ch - 'a';
-		if (!node->children[i]) continue;
+		if (!has_child(node, i)) continue;
 
-		current.push_back(ch); // Tentatively add this Trie character to our current word path
+		// column 0: every character of the path is an insertion relative to an empty target prefix
+		rows[next_row] = rows[row] + 1;
+		int row_min = rows[next_row];
 
-		if (ch == target_ch) {
-			// A) Perfect match (no edits)
-			// If the Trie character matches the target character, no edit is consumed
-			// We advance in both the Trie (to child) and the target string (to next index)
-			search_fuzzy(node->children[i].get(), target, current, index + 1, edits_remaining, results, edits_used);
-		}
-		else {
-			// B) Substitution (1 edit)
-			// If the Trie character DOES NOT match the target character, one edit is consumed
-			// We advance in both Trie and target string
-			search_fuzzy(node->children[i].get(), target, current, index + 1, edits_remaining - 1, results, edits_used + 1);
+		for (size_t j = 1; j < width; ++j) {
+			int substitution = rows[row + j - 1] + (target[j - 1] == ch ? 0 : 1); // match or substitution
+			int insertion = rows[row + j] + 1;                                    // trie character inserted into target
+			int deletion = rows[next_row + j - 1] + 1;                            // target character deleted
+			rows[next_row + j] = std::min(substitution, std::min(insertion, deletion));
+			row_min = std::min(row_min, rows[next_row + j]);
 		}
 
-		// C) Insertion (into target string)
-		// This simulates inserting the current Trie character into the target string
-		// We advance in the Trie (to child) but DO NOT advance in the target string
-		// This implies that the 'ch' character from the Trie is "inserted" into the target before
-		// One edit is consumed
-		search_fuzzy(node->children[i].get(), target, current, index, edits_remaining - 1, results, edits_used + 1);
+		// [3] pruning: cells only grow going down, so once the whole row is over budget no word below can match
+		if (row_min > max_edits) continue;
+
+		current.push_back(ch);
+		search_fuzzy(child(node, i), target, current, rows, max_edits, results);
+		current.pop_back();
+	}
+}
+
+void Trie::search_fuzzy_bit_parallel(TrieNode* node, const MyersPattern& pattern, const MyersState& state, std::string& current, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// same traversal as search_fuzzy with the DP column packed into two machine words
+	if (node->is_end_of_word && state.score <= max_edits) {
+		results[current] = FuzzyMatch{ current, node->frequency, state.score };
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		int i = ch - 'a';
+		if (!has_child(node, i)) continue;
+
+		MyersState next = pattern.step(state, ch);
+
+		// the bound is weaker than the exact row minimum, so this prunes a little later than DP_ROWS,
+		// but matches are only reported from the exact score and stay identical
+		if (pattern.lower_bound(next, static_cast<int>(current.size()) + 1) > max_edits) continue;
 
+		current.push_back(ch);
+		search_fuzzy_bit_parallel(child(node, i), pattern, next, current, max_edits, results);
 		current.pop_back();
 	}
+}
+
+void Trie::search_deletion_index(const std::string& input, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// the index only narrows the dictionary down to candidates, the exact distance decides
+	MyersPattern pattern(input);
+	for (const std::string* word : deletion_index->candidates(input, max_edits)) {
+		int distance = pattern.distance(*word);
+		if (distance > max_edits) continue;
+
+		// frequencies change with log_selection, so they are read from the trie rather than stored in the index
+		TrieNode* node = find_node(*word);
+		if (node && node->is_end_of_word) {
+			results[*word] = FuzzyMatch{ *word, node->frequency, distance };
+		}
+	}
+}
 
-	// D) Deletion (skip char in word)
-	// This simulates deleting the current target character ('target_ch') from the target string.
-	// We DO NOT advance in the Trie (stay at the same node) but advance in the target string (index + 1).
-	// This implies that target_ch is deleted and we move on to try matching the next target character
-	// with the same Trie node. One edit is consumed.
-	search_fuzzy(node, target, current, index + 1, edits_remaining - 1, results, edits_used + 1);
+void Trie::enable_deletion_index(int max_edits, size_t max_input_length)
+{
+	// candidates are verified with the bit-parallel distance, which handles inputs of up to 64 characters
+	if (max_input_length > MyersPattern::MAX_LENGTH) max_input_length = MyersPattern::MAX_LENGTH;
+	deletion_index.reset(new DeletionIndex(max_edits, max_input_length));
 
+	for (const std::pair<std::string, int>& word : get_all_words()) {
+		deletion_index->add(word.first);
+	}
+}
+
+void Trie::search_fuzzy_automaton(TrieNode* node, LevenshteinAutomaton& automaton, int state, std::string& current, std::unordered_map<std::string, FuzzyMatch>& results) const
+{
+	// same traversal as search_fuzzy, but the DP row is replaced by the automaton state it was interned as
+	int distance = automaton.distance(state);
+	if (node->is_end_of_word && distance >= 0) {
+		results[current] = FuzzyMatch{ current, node->frequency, distance };
+	}
+
+	for (char ch = 'a'; ch <= 'z'; ++ch) {
+		int i = ch - 'a';
+		if (!has_child(node, i)) continue;
+
+		int next = automaton.step(state, ch);
+		if (next == LevenshteinAutomaton::DEAD) continue; // every cell over budget, prune the subtree
+
+		current.push_back(ch);
+		search_fuzzy_automaton(child(node, i), automaton, next, current, results);
+		current.pop_back();
+	}
 }
 
 std::vector<FuzzyMatch> Trie::get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha) const
 {	
-	// entry point method for kicking in recursive fuzzy search
+	// entry point method for kicking in the fuzzy search
 	// max_edits is LevenshteinDistance = minimum number of single-character edits (insertions, deletions, or substitutions) required to change one word into another 
 	// example -> LevenshteinDistance("kitten", "sitting") = 3
 
@@ -273,18 +690,43 @@ std::vector<FuzzyMatch> Trie::get_ranked_fuzzy_matches(const std::string& input,
 	// max_edits = LevenshteinDistance, by default allows one edit per word [ applw = apple ]
 	std::unordered_map<std::string, FuzzyMatch> result_map;
 	std::string current;
-	search_fuzzy(root.get(), input, current, 0, max_edits, result_map, 0);
+	if (max_edits < 0) return {};
 
-	std::vector<FuzzyMatch> result_vec;
-	for (auto& pair : result_map) {
-		FuzzyMatch& match = pair.second;
-		match.score = match.frequency - alpha * match.edit_distance;
-		result_vec.push_back(match);
+	if (deletion_index && deletion_index->covers(input, max_edits)) {
+		search_deletion_index(input, max_edits, result_map);
+		return rank_fuzzy_matches(result_map, alpha);
 	}
 
-	std::sort(result_vec.begin(), result_vec.end()); // uses operator<
+	if (fuzzy_pool && max_edits >= PARALLEL_FUZZY_MIN_EDITS) {
+		return get_ranked_fuzzy_matches_parallel(input, max_edits, alpha);
+	}
 
-	return result_vec;
+	switch (fuzzy_engine) {
+	case FuzzyEngine::AUTOMATON: {
+		LevenshteinAutomaton automaton(input, max_edits);
+		search_fuzzy_automaton(root, automaton, automaton.start(), current, result_map);
+		break;
+	}
+	case FuzzyEngine::BIT_PARALLEL:
+		if (input.size() <= MyersPattern::MAX_LENGTH) {
+			MyersPattern pattern(input);
+			search_fuzzy_bit_parallel(root, pattern, pattern.start(), current, max_edits, result_map);
+			break;
+		}
+		// fall through - longer inputs do not fit in one machine word, use the DP rows
+	case FuzzyEngine::DP_ROWS:
+	default: {
+		// the row for the empty path: reaching input[0, i) takes i deletions
+		std::vector<int> rows(input.size() + 1);
+		for (size_t i = 0; i < rows.size(); ++i) {
+			rows[i] = static_cast<int>(i);
+		}
+		search_fuzzy(root, input, current, rows, max_edits, result_map);
+		break;
+	}
+	}
+
+	return rank_fuzzy_matches(result_map, alpha);
 }
 
 void Trie::debug_print_recursive(TrieNode* node, std::string& current, int depth) const
@@ -298,9 +740,9 @@ void Trie::debug_print_recursive(TrieNode* node, std::string& current, int depth
 
 	for (char ch = 'a'; ch <= 'z'; ++ch) {
 		int index = ch - 'a';
-		if (node->children[index]) {
+		if (has_child(node, index)) {
 			current.push_back(ch);
-			debug_print_recursive(node->children[index].get(), current, depth + 1);
+			debug_print_recursive(child(node, index), current, depth + 1);
 			current.pop_back();
 		}
 	}
@@ -309,31 +751,206 @@ void Trie::debug_print_recursive(TrieNode* node, std::string& current, int depth
 
 void Trie::load_from_file(const std::string& filename)
 {
-	std::ifstream in(filename);
+	std::ifstream in(filename, std::ios::binary);
 	if (!in) {
 		std::cerr << "No saved data found (" << filename << ").\n";
 		return;
 	}
 
+	// a binary dictionary is read through the mapping instead of being parsed
+	char magic[sizeof(DICTIONARY_MAGIC)] = {};
+	in.read(magic, sizeof(magic));
+	if (in && std::equal(magic, magic + sizeof(magic), DICTIONARY_MAGIC)) {
+		MappedDictionary dictionary;
+		if (dictionary.open(filename)) {
+			load_words(dictionary.get_all_words());
+		}
+		return;
+	}
+	in.clear();
+	in.seekg(0);
+
+	// saved dictionaries are sorted, so an empty trie is bulk-built until a word arrives out of order
+	std::unique_ptr<SortedBuilder> builder;
+	if (empty()) builder.reset(new SortedBuilder(*this));
+
 	std::string word;
 	int freq;
 	while (in >> word >> freq) {
+		if (builder && builder->add(word, freq)) continue;
+		builder.reset(); // closes the built part, the rest goes through insert
 		insert(word, freq);
 	}
 
 }
 
-void Trie::save_to_file(const std::string& filename) const
+void Trie::load_words(const std::vector<std::pair<std::string, int>>& words)
+{
+	std::unique_ptr<SortedBuilder> builder;
+	if (empty()) builder.reset(new SortedBuilder(*this));
+
+	for (const std::pair<std::string, int>& word : words) {
+		if (builder && builder->add(word.first, word.second)) continue;
+		builder.reset();
+		insert(word.first, word.second);
+	}
+}
+
+void Trie::load_from_file_parallel(const std::string& filename, unsigned threads)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads <= 1 || !empty()) {
+		load_from_file(filename);
+		return;
+	}
+
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) {
+		std::cerr << "No saved data found (" << filename << ").\n";
+		return;
+	}
+
+	// the words of each letter's subtree, with the letter itself removed, in file order
+	std::array<std::vector<std::pair<std::string, int>>, 26> partitions;
+	bool has_empty_word = false; // a word without letters, stored in root itself
+	int empty_word_frequency = 0;
+	std::array<size_t, 26> order; // biggest partitions are built first, so no thread is left with a big one at the end
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+	char magic[sizeof(DICTIONARY_MAGIC)] = {};
+	in.read(magic, sizeof(magic));
+	if (in && std::equal(magic, magic + sizeof(magic), DICTIONARY_MAGIC)) {
+		in.close();
+		MappedDictionary dictionary;
+		if (!dictionary.open(filename)) return;
+
+		// the mapping is only read, every thread walks its own letters' subtrees
+		run_in_parallel(threads, partitions.size(), [&](size_t i) {
+			partitions[i] = dictionary.get_words_with_prefix(std::string(1, static_cast<char>('a' + i)));
+			for (std::pair<std::string, int>& word : partitions[i]) word.first.erase(0, 1);
+		});
+		if (dictionary.contains("")) {
+			has_empty_word = true;
+			empty_word_frequency = dictionary.frequency_of("");
+		}
+	}
+	else {
+		in.clear();
+		in.seekg(0, std::ios::end);
+		std::string text(static_cast<size_t>(in.tellg()), '\0');
+		in.seekg(0);
+		in.read(&text[0], text.size());
+		in.close();
+
+		// one chunk per thread, cut right after a newline so no line is split
+		const size_t MIN_CHUNK = 1 << 16;
+		size_t chunk_count = std::max<size_t>(1, std::min<size_t>(threads, text.size() / MIN_CHUNK));
+		std::vector<size_t> bounds{ 0 };
+		for (size_t c = 1; c < chunk_count; ++c) {
+			size_t cut = std::max(bounds.back(), text.size() * c / chunk_count);
+			cut = text.find('\n', cut);
+			bounds.push_back(cut == std::string::npos ? text.size() : cut + 1);
+		}
+		bounds.push_back(text.size());
+
+		std::vector<ParsedChunk> chunks(chunk_count);
+		run_in_parallel(threads, chunk_count, [&](size_t c) {
+			parse_chunk(text.data() + bounds[c], text.data() + bounds[c + 1], chunks[c]);
+		});
+
+		// like the sequential loader, nothing after the first malformed line is loaded
+		size_t usable = 0;
+		while (usable < chunk_count && !chunks[usable++].malformed) {}
+
+		run_in_parallel(threads, partitions.size(), [&](size_t i) {
+			size_t total = 0;
+			for (size_t c = 0; c < usable; ++c) total += chunks[c].words[i].size();
+			partitions[i].reserve(total);
+			for (size_t c = 0; c < usable; ++c) {
+				std::move(chunks[c].words[i].begin(), chunks[c].words[i].end(), std::back_inserter(partitions[i]));
+				std::vector<std::pair<std::string, int>>().swap(chunks[c].words[i]);
+			}
+		});
+		for (size_t c = 0; c < usable; ++c) {
+			if (chunks[c].has_empty_word) {
+				has_empty_word = true;
+				empty_word_frequency = chunks[c].empty_word_frequency;
+			}
+		}
+
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return partitions[a].size() > partitions[b].size(); });
+	}
+
+	// every subtree is an independent trie, built without any shared state
+	std::vector<Trie> subtries(partitions.size());
+	run_in_parallel(threads, order.size(), [&](size_t n) {
+		size_t i = order[n];
+		subtries[i].load_words(partitions[i]);
+		std::vector<std::pair<std::string, int>>().swap(partitions[i]);
+	});
+
+	splice_subtries(subtries, threads);
+
+	root->is_end_of_word = has_empty_word;
+	root->frequency = empty_word_frequency;
+	root->max_frequency = subtree_max_frequency(root);
+
+	if (deletion_index) enable_deletion_index(deletion_index->get_max_edits(), deletion_index->get_max_input_length());
+}
+
+void Trie::splice_subtries(const std::vector<Trie>& subtries, unsigned threads)
+{
+	uint32_t version = ++dictionary_version;
+	root->version = version;
+
+	// node ids and slot offsets of each subtrie are shifted past the ones in use before it;
+	// the ranges are reserved up front so the copies can run in parallel without touching shared state
+	std::vector<uint32_t> node_offsets(subtries.size());
+	std::vector<uint32_t> slot_offsets(subtries.size());
+	for (size_t i = 0; i < subtries.size(); ++i) {
+		if (subtries[i].empty()) continue;
+		node_offsets[i] = nodes.allocate_range(subtries[i].nodes.size());
+		slot_offsets[i] = child_slots.allocate_range(subtries[i].child_slots.size());
+		child_slots.adopt_free_blocks(subtries[i].child_slots, slot_offsets[i]);
+	}
+
+	run_in_parallel(threads, subtries.size(), [&](size_t i) {
+		const Trie& sub = subtries[i];
+		if (sub.empty()) return;
+
+		for (uint32_t id = 0; id < sub.nodes.size(); ++id) {
+			TrieNode& node = nodes[node_offsets[i] + id];
+			node = sub.nodes[id];
+			node.version = version;
+			if (node.child_mask != 0) node.child_block += slot_offsets[i];
+		}
+		for (uint32_t slot = 0; slot < sub.child_slots.size(); ++slot) {
+			child_slots[slot_offsets[i] + slot] = sub.child_slots[slot] + node_offsets[i];
+		}
+	});
+
+	// the root of a subtrie (its node 0) stands for the letter itself
+	for (size_t i = 0; i < subtries.size(); ++i) {
+		if (!subtries[i].empty()) child_slots.insert(root->child_mask, root->child_block, i, node_offsets[i]);
+	}
+}
+
+void Trie::save_to_file(const std::string& filename, DictionaryFormat format, uint32_t generation) const
 {	
-	std::ofstream out(filename);
+	std::ofstream out(filename, format == DictionaryFormat::BINARY ? std::ios::binary : std::ios::out);
 	if (!out) {
 		std::cerr << "Failed to open file for saving.\n";
 		return;
 	}
 
+	if (format == DictionaryFormat::BINARY) {
+		save_binary(out, generation);
+		return;
+	}
+
 	std::vector<std::pair<std::string, int>> words;
 	std::string current;
-	collect_all_words(root.get(), current, words);	
+	collect_all_words(root, current, words);	
 
 	for (const std::pair<std::string, int>& pair : words){
 		std::string word = pair.first;
@@ -342,6 +959,56 @@ void Trie::save_to_file(const std::string& filename) const
 	}
 }
 
+void Trie::save_binary(std::ostream& out, uint32_t generation) const
+{
+	// breadth-first numbering puts the children of every node next to each other, so a node only needs
+	// the number of its first child; the child mask (same bits as in memory) locates the others
+	std::vector<const TrieNode*> order{ root };
+	std::vector<DictionaryNode> flat;
+	flat.reserve(nodes.size());
+
+	for (size_t i = 0; i < order.size(); ++i) {
+		const TrieNode* node = order[i];
+
+		DictionaryNode entry;
+		entry.child_mask = node->child_mask | (node->is_end_of_word ? DictionaryNode::END_OF_WORD : 0);
+		entry.first_child = static_cast<uint32_t>(order.size());
+		entry.frequency = node->frequency;
+		entry.max_frequency = node->max_frequency;
+		flat.push_back(entry);
+
+		for (size_t index = 0; index < 26; ++index) {
+			if (has_child(node, index)) order.push_back(child(node, index));
+		}
+	}
+
+	DictionaryHeader header;
+	std::copy(DICTIONARY_MAGIC, DICTIONARY_MAGIC + sizeof(DICTIONARY_MAGIC), header.magic);
+	header.version = DICTIONARY_VERSION;
+	header.node_count = static_cast<uint32_t>(flat.size());
+	header.generation = generation;
+	header.reserved = 0;
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(flat.data()), flat.size() * sizeof(DictionaryNode));
+	if (!out) {
+		std::cerr << "Failed to write the binary dictionary.\n";
+	}
+}
+
+std::vector<std::pair<std::string, int>> Trie::get_all_words() const
+{
+	std::vector<std::pair<std::string, int>> words;
+	std::string current;
+	collect_all_words(root, current, words);
+	return words;
+}
+
+DoubleArrayTrie Trie::freeze() const
+{
+	return DoubleArrayTrie(get_all_words());
+}
+
 void Trie::collect_all_words(TrieNode* node, std::string& current, std::vector<std::pair<std::string, int>>& out) const
 {
 	if (node->is_end_of_word) {
@@ -350,9 +1017,9 @@ void Trie::collect_all_words(TrieNode* node, std::string& current, std::vector<s
 
 	for (char ch = 'a'; ch <= 'z'; ch++) {
 		int index = ch - 'a';
-		if (node->children[index]) {
+		if (has_child(node, index)) {
 			current.push_back(ch);
-			collect_all_words(node->children[index].get(), current, out);
+			collect_all_words(child(node, index), current, out);
 			current.pop_back();
 		}
 	}
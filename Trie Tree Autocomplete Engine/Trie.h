@@ -5,94 +5,239 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <cstdint>
+#include <climits>
+#include "NodePool.h"
+#include "FuzzyMatch.h"
+#include "DeletionIndex.h"
+
+class DoubleArrayTrie;
+class ThreadPool;
+class LevenshteinAutomaton;
+class MyersPattern;
+struct MyersState;
+
+// algorithm used to find the fuzzy candidates, every engine returns the same matches
+enum class FuzzyEngine {
+	DP_ROWS,   // one Levenshtein DP row per trie depth
+	AUTOMATON, // Levenshtein automaton intersected with the trie, one table lookup per child
+	BIT_PARALLEL // Myers' bit-vector columns, inputs longer than 64 characters fall back to DP_ROWS
+};
+
+// on-disk formats of Trie::save_to_file, load_from_file recognizes either one
+enum class DictionaryFormat {
+	TEXT,  // one "word frequency" line per word
+	BINARY // flattened nodes that MappedDictionary queries in place, see MappedDictionary.h
+};
+
+class Trie {
+
+	friend class CompletionSession; // keeps trie nodes between keystrokes
+
+private:
+
+	static const int NO_WORDS = INT_MIN;
+
+	class TrieNode {
+
+	public:
+
+		// sparse child representation: bit i of child_mask is set when the child for 'a' + i exists,
+		// and the existing children are stored densely (in letter order) in a block of child_slots
+		// so the child for letter i sits at child_block + popcount(child_mask bits below i)
+		uint32_t child_mask;
+		uint32_t child_block;
 
+		int frequency = 0;
+
+		// highest frequency of any word in this subtree (this node included), NO_WORDS when there is none
+		// lets the top-k search skip every subtree that cannot beat the words already found
+		int max_frequency;
+
+		bool is_end_of_word;
+
+		// dictionary version of the last change to this subtree (see version(prefix)), 32 bits keep the node small
+		uint32_t version;
+
+		// node does not contain symbol character but they are known based on children index
 
+		TrieNode() : child_mask(0), child_block(0), max_frequency(NO_WORDS), is_end_of_word(false), version(0) {}
 
-struct FuzzyMatch {
-	std::string word;
-	int frequency;
-	int edit_distance;
-	double score;
+	};
 
-	bool operator<(const FuzzyMatch& other) const {
-		// --- NEW LOGIC FOR EDIT_DISTANCE == 0 PRIORITIZATION ---
+	// all nodes are owned by the pool and freed together when the trie is destroyed
+	NodePool<TrieNode> nodes;
+	ChildSlotPool child_slots;
+	TrieNode* root;
 
-		// Case 1: 'this' has edit_distance 0, 'other' does not.
-		// 'this' should come before 'other' (return true).
-		if (this->edit_distance == 0 && other.edit_distance != 0) {
-			return true;
-		}
+	FuzzyEngine fuzzy_engine = FuzzyEngine::DP_ROWS;
 
-		// Case 2: 'other' has edit_distance 0, 'this' does not.
-		// 'this' should come after 'other' (return false).
-		if (this->edit_distance != 0 && other.edit_distance == 0) {
-			return false;
-		}
+	// optional, answers short fuzzy queries without walking the trie (see enable_deletion_index)
+	std::unique_ptr<DeletionIndex> deletion_index;
 
-		// --- EXISTING LOGIC (when edit_distance status is the same for both) ---
-		// This part is reached if:
-		// A) Both 'this' and 'other' have edit_distance == 0
-		// B) Both 'this' and 'other' have edit_distance > 0
+	// optional, not owned: fuzzy searches fan out over the root's subtrees on it (see set_fuzzy_thread_pool)
+	ThreadPool* fuzzy_pool = nullptr;
 
-		// Primary sort: descending by score
-		// If scores are different, the one with the higher score comes first.
-		// (score > other.score means 'this' is "less than" 'other' if we want descending order)
-		if (score != other.score) {
-			return score > other.score;
-		}
+	// bumped by every change; a change stamps the nodes on its path, and new nodes start out with the current value
+	uint32_t dictionary_version = 0;
 
-		// Secondary sort (for ties in score): ascending by word (lexicographical)
-		// If scores are equal, the one with the lexicographically smaller word comes first.
-		return word < other.word;
+	bool has_child(const TrieNode* node, size_t index) const {
+		return index < 26 && ((node->child_mask >> index) & 1u);
 	}
-};
 
+	TrieNode* child(const TrieNode* node, size_t index) const {
+		if (!has_child(node, index)) return nullptr;
+		return const_cast<TrieNode*>(&nodes[child_slots.child_slot(node->child_mask, node->child_block, index)]);
+	}
 
-class Trie {
+	TrieNode* add_child(TrieNode* node, size_t index);
+	TrieNode* find_node(const std::string& word) const;
 
-private:
+	int subtree_max_frequency(const TrieNode* node) const;
+	void update_max_frequency(const std::vector<TrieNode*>& path);
 
-	class TrieNode {
+public:
+
+	Trie() { root = &nodes[nodes.allocate()]; }
+
+	// Builds an empty trie from words arriving in sorted order, in one left-to-right pass.
+	// Only the path of the previous word is kept open (as a stack); a word sharing the first n letters
+	// with it closes everything below depth n, computing each closed node's max_frequency from its
+	// already closed children, and appends the rest of its letters as new last children.
+	// No word re-walks its prefix from the root and no subtree maximum is ever recomputed.
+	class SortedBuilder {
 
 	public:
 
-		bool is_end_of_word;
-		std::array<std::unique_ptr<TrieNode>, 26> children;
+		explicit SortedBuilder(Trie& trie);
+		~SortedBuilder() { finish(); }
 
-		int frequency = 0;
+		SortedBuilder(const SortedBuilder&) = delete;
+		SortedBuilder& operator=(const SortedBuilder&) = delete;
 
-		// node does not contain symbol character but they are known based on children index
+		// false, adding nothing, when word (as insert would store it) sorts before the previous one
+		bool add(const std::string& word, int freq);
 
-		TrieNode() : is_end_of_word(false) {}
+		// closes the remaining path, the trie is complete afterwards
+		void finish();
 
-	};
+	private:
 
-	std::unique_ptr<TrieNode> root;
+		Trie& trie;
+		std::vector<TrieNode*> path; // path[d] is the node for the first d letters of previous
+		std::string previous;
+		std::string scratch;
+		bool finished = false;
 
-public:
+		void close_below(size_t depth);
+	};
+
+	bool empty() const { return root->child_mask == 0 && !root->is_end_of_word; }
 
-	Trie() : root(std::make_unique<TrieNode>()) {}
+	static const int SELECTION_BONUS = 5; // frequency gained by a word every time it is selected
 
 	void insert(const std::string& word, int freq = 1);
 	void log_selection(const std::string& word);
 
+	// adds delta to the frequency of an existing word, does nothing for a missing one
+	void add_frequency(const std::string& word, int delta);
+
+	// changes whenever a word or a frequency does, so results remembered for one version (see QueryCache)
+	// are known to be stale once it moves on
+	uint64_t version() const { return dictionary_version; }
+
+	// the same for the subtree of prefix only: changes when a word starting with prefix is added or changes frequency.
+	// Prefix and fuzzy top-k results for prefix depend on nothing else (the fuzzy results are filtered down to
+	// prefix completions), so selecting one word leaves the results of every unrelated query valid.
+	uint64_t version(const std::string& prefix) const;
+
 	std::vector<std::string> get_top_k_with_prefix(const std::string& prefix, int k) const;
 	
 	void dfs(TrieNode* node, std::string& current, std::vector<std::pair<std::string, int>>& results) const;
 
+	// the top k prefix completions within max_edits of input, ranked as fuzzy matches with the prefix boost
 	std::vector<FuzzyMatch> get_top_k_fuzzy_matches(const std::string& input, int max_edits, int k) const;
+
+	// every word within max_edits of input, scored frequency - alpha * edit_distance and sorted.
+	// This is the search the fuzzy engines, the deletion index and the thread pool speed up
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
+
+	// the same queries for many inputs at once, results in input order.
+	// The inputs are sorted, so each walk down the trie starts from the node of the prefix it shares with the
+	// previous input, and repeated inputs are answered once.
+	std::vector<std::vector<std::string>> get_top_k_with_prefix_batch(const std::vector<std::string>& prefixes, int k) const;
+	std::vector<std::vector<FuzzyMatch>> get_top_k_fuzzy_matches_batch(const std::vector<std::string>& inputs, int max_edits, int k) const;
+
+	void set_fuzzy_engine(FuzzyEngine engine) { fuzzy_engine = engine; }
+	FuzzyEngine get_fuzzy_engine() const { return fuzzy_engine; }
+
+	// from PARALLEL_FUZZY_MIN_EDITS edits up, get_ranked_fuzzy_matches searches the subtree of every root child as
+	// a separate task on pool and merges their matches; the matches are the same as on one thread
+	// nullptr searches on the calling thread again, the pool must outlive its use by the trie
+	void set_fuzzy_thread_pool(ThreadPool* pool) { fuzzy_pool = pool; }
+
+	// below this edit budget a search takes a few microseconds, less than handing tasks to other threads
+	static const int PARALLEL_FUZZY_MIN_EDITS = 2;
+
+	// builds a deletion index over the current words and keeps it up to date on insert
+	// fuzzy queries of up to max_input_length characters and up to max_edits edits are then answered from it,
+	// trading memory (every word is stored under all of its deletion variants) for near-constant lookup time
+	void enable_deletion_index(int max_edits = 2, size_t max_input_length = 8);
+	void disable_deletion_index() { deletion_index.reset(); }
+	bool has_deletion_index() const { return deletion_index != nullptr; }
 	
 	void debug_print() const;
 
-	void save_to_file(const std::string& filename) const;
+	// every word with its frequency, sorted lexicographically
+	std::vector<std::pair<std::string, int>> get_all_words() const;
+
+	// compiles the current dictionary into a read-only double-array trie for serving
+	DoubleArrayTrie freeze() const;
+
+	size_t node_count() const { return nodes.size(); }
+	size_t memory_usage() const {
+		return nodes.memory_usage() + child_slots.memory_usage() + (deletion_index ? deletion_index->memory_usage() : 0);
+	}
+
+	// generation is stamped into a binary dictionary's header, see UpdateLog
+	void save_to_file(const std::string& filename, DictionaryFormat format = DictionaryFormat::TEXT, uint32_t generation = 0) const;
 	void load_from_file(const std::string& filename);
 
+	// inserts every word, bulk-building an empty trie while the words come in sorted order
+	void load_words(const std::vector<std::pair<std::string, int>>& words);
+
+	// load_from_file on several threads (0 = one per hardware thread), for large dictionaries.
+	// The words are split by their first letter, each letter's subtree is built as a separate trie in parallel,
+	// and the finished subtrees are spliced under root. Text input is parsed in parallel chunks as well.
+	// A trie that is not empty is loaded sequentially.
+	void load_from_file_parallel(const std::string& filename, unsigned threads = 0);
+
 private:
 
 	std::vector<std::pair<std::string, int>> get_words_with_prefix(const std::string& prefix) const;
+
+	// best-first top k of the subtree of node, whose path is prefix
+	std::vector<std::string> get_top_k_below(const TrieNode* node, const std::string& prefix, int k) const;
+
+	// get_top_k_fuzzy_matches of input, given its top k prefix completions. Only matches that are among those
+	// completions are kept, and a completion is reached from input by inserting its remaining letters, never in
+	// fewer edits, so the result follows from the completions alone without any fuzzy search.
+	std::vector<FuzzyMatch> fuzzy_matches_from_completions(const std::string& input, const std::vector<std::string>& completions, int max_edits, int k) const;
+
+	// the positions of queries in sorted order, and in nodes the node of every query (nullptr when it leaves the trie)
+	std::vector<size_t> find_batch_nodes(const std::vector<std::string>& queries, std::vector<const TrieNode*>& nodes) const;
 	
-	std::vector<FuzzyMatch> get_ranked_fuzzy_matches(const std::string& input, int max_edits, double alpha = 1) const;
-	void search_fuzzy(TrieNode* node, const std::string& target, std::string& current, int index, int edits_remaining, std::unordered_map<std::string, FuzzyMatch>& results, int edits_used) const;
+	std::vector<FuzzyMatch> get_ranked_fuzzy_matches_parallel(const std::string& input, int max_edits, double alpha) const;
+	void search_fuzzy_subtree(size_t index, const std::string& input, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+	void search_fuzzy(TrieNode* node, const std::string& target, std::string& current, std::vector<int>& rows, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+	void search_fuzzy_bit_parallel(TrieNode* node, const MyersPattern& pattern, const MyersState& state, std::string& current, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+	void search_deletion_index(const std::string& input, int max_edits, std::unordered_map<std::string, FuzzyMatch>& results) const;
+	void search_fuzzy_automaton(TrieNode* node, LevenshteinAutomaton& automaton, int state, std::string& current, std::unordered_map<std::string, FuzzyMatch>& results) const;
+
+	void save_binary(std::ostream& out, uint32_t generation) const;
+
+	// copies the nodes of every non-empty subtries[i] into this trie (in parallel) and makes its root the child of root for letter i
+	void splice_subtries(const std::vector<Trie>& subtries, unsigned threads);
 
 	void collect_all_words(TrieNode* node, std::string& current, std::vector<std::pair<std::string, int>>& out) const;
 
@@ -0,0 +1,178 @@
+#include "UpdateLog.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+	const char UPDATE_LOG_MAGIC[8] = { 'C', 'S', 'U', 'P', 'D', 'L', 'O', 'G' };
+	const uint32_t UPDATE_LOG_VERSION = 1;
+	const uint32_t MAX_WORD_LENGTH = 1u << 16; // anything longer is a corrupt length field
+
+	template <typename T>
+	bool read_value(std::istream& in, T& value)
+	{
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return static_cast<bool>(in);
+	}
+
+	template <typename T>
+	void write_value(std::ostream& out, const T& value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+}
+
+bool UpdateLog::open(const std::string& filename, uint32_t generation, const Apply& apply)
+{
+	close();
+	this->filename = filename;
+
+	std::string valid_records; // raw bytes of every record that checked out
+	LogState state = read_records(generation, apply, valid_records);
+	if (state == LogState::NEWER) {
+		// its records are not in the dictionary that was opened, and dropping them would lose them for good
+		std::cerr << "The update log belongs to a newer dictionary than the one opened, it is left as it is (" << filename << ").\n";
+		return false;
+	}
+	if (state == LogState::OLDER) {
+		std::cerr << "Discarding the update log of an older dictionary (" << filename << ").\n";
+	}
+
+	if (state != LogState::CURRENT) {
+		// new, stale or torn log: keep exactly the valid records, written aside first so they are never at risk
+		std::string temporary = filename + ".tmp";
+		std::ofstream fresh(temporary, std::ios::binary | std::ios::trunc);
+		if (write_header(fresh, generation)) fresh.write(valid_records.data(), valid_records.size());
+		fresh.close();
+		if (!fresh) {
+			std::cerr << "Failed to write the update log (" << temporary << ").\n";
+			std::remove(temporary.c_str()); // never leave a partial log behind
+			return false;
+		}
+
+		if (!replace_file(temporary, filename)) {
+			std::cerr << "Failed to replace the update log (" << filename << ").\n";
+			std::remove(temporary.c_str());
+			return false;
+		}
+	}
+
+	out.open(filename, std::ios::binary | std::ios::app);
+	if (!out) {
+		std::cerr << "Failed to open the update log (" << filename << ").\n";
+		return false;
+	}
+	return true;
+}
+
+void UpdateLog::replay(const std::string& filename, uint32_t generation, const Apply& apply)
+{
+	close();
+	this->filename = filename;
+
+	std::string valid_records;
+	read_records(generation, apply, valid_records);
+}
+
+UpdateLog::LogState UpdateLog::read_records(uint32_t generation, const Apply& apply, std::string& valid_records)
+{
+	records = 0;
+
+	std::ifstream in(filename, std::ios::binary);
+	if (!in) return LogState::REPAIR;
+
+	char magic[sizeof(UPDATE_LOG_MAGIC)];
+	uint32_t version = 0;
+	uint32_t log_generation = 0;
+	in.read(magic, sizeof(magic));
+	bool header_ok = in
+		&& std::equal(magic, magic + sizeof(magic), UPDATE_LOG_MAGIC)
+		&& read_value(in, version) && version == UPDATE_LOG_VERSION
+		&& read_value(in, log_generation);
+
+	if (!header_ok) return LogState::REPAIR;
+	if (log_generation < generation) return LogState::OLDER;
+	if (log_generation > generation) return LogState::NEWER;
+
+	while (true) {
+		uint32_t length = 0;
+		in.read(reinterpret_cast<char*>(&length), sizeof(length));
+		if (in.gcount() == 0) return LogState::CURRENT; // clean end of the log
+		if (!in || length > MAX_WORD_LENGTH) return LogState::REPAIR;
+
+		std::string word(length, '\0');
+		int32_t delta = 0;
+		uint32_t sum = 0;
+		if (!in.read(&word[0], length) || !read_value(in, delta) || !read_value(in, sum) || sum != checksum(word, delta)) {
+			return LogState::REPAIR;
+		}
+
+		apply(word, delta);
+		++records;
+
+		valid_records.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		valid_records.append(word);
+		valid_records.append(reinterpret_cast<const char*>(&delta), sizeof(delta));
+		valid_records.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+	}
+}
+
+bool UpdateLog::append(const std::string& word, int delta)
+{
+	if (!out.is_open() || word.size() > MAX_WORD_LENGTH) return false;
+
+	uint32_t length = static_cast<uint32_t>(word.size());
+	int32_t value = delta;
+	write_value(out, length);
+	out.write(word.data(), word.size());
+	write_value(out, value);
+	write_value(out, checksum(word, value));
+
+	// hand the record to the OS right away, a crash of the program then loses nothing
+	out.flush();
+	if (!out) return false;
+
+	++records;
+	return true;
+}
+
+bool UpdateLog::reset(uint32_t generation)
+{
+	close();
+	records = 0;
+
+	std::ofstream fresh(filename, std::ios::binary | std::ios::trunc);
+	if (!write_header(fresh, generation)) return false;
+	fresh.close();
+
+	out.open(filename, std::ios::binary | std::ios::app);
+	return static_cast<bool>(out);
+}
+
+bool UpdateLog::write_header(std::ofstream& stream, uint32_t generation) const
+{
+	if (!stream) {
+		std::cerr << "Failed to open the update log for writing.\n";
+		return false;
+	}
+	stream.write(UPDATE_LOG_MAGIC, sizeof(UPDATE_LOG_MAGIC));
+	write_value(stream, UPDATE_LOG_VERSION);
+	write_value(stream, generation);
+	return static_cast<bool>(stream);
+}
+
+uint32_t UpdateLog::checksum(const std::string& word, int32_t delta)
+{
+	// FNV-1a over the word and the delta, enough to tell a torn or garbled record from a complete one
+	uint32_t hash = 2166136261u;
+	auto mix = [&hash](uint8_t byte) {
+		hash ^= byte;
+		hash *= 16777619u;
+	};
+	for (char ch : word) mix(static_cast<uint8_t>(ch));
+	for (size_t i = 0; i < sizeof(delta); ++i) mix(static_cast<uint8_t>(static_cast<uint32_t>(delta) >> (8 * i)));
+	return hash;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+
+// Append-only log of frequency updates, so learned selections are persisted as they happen at a cost
+// proportional to the activity instead of rewriting the whole dictionary.
+//
+//     magic "CSUPDLOG", uint32 version, uint32 generation
+//     records: uint32 word length, word bytes, int32 delta, uint32 checksum
+//
+// generation is the generation of the dictionary image the records apply to. Compaction writes the updates
+// into a new image with the next generation first and only then resets the log, so a crash in between leaves
+// a log of an older generation, which is dropped instead of being applied twice. A log of a newer generation
+// than the dictionary means the image it belongs to could not be opened; it is never touched.
+// Every record is flushed when appended; a torn record at the end (crash mid-write) fails its checksum and
+// is dropped together with anything after it.
+class UpdateLog {
+
+public:
+
+	using Apply = std::function<void(const std::string& word, int delta)>;
+
+	UpdateLog() = default;
+	UpdateLog(const UpdateLog&) = delete;
+	UpdateLog& operator=(const UpdateLog&) = delete;
+
+	// replays the records written against this dictionary generation through apply and opens the log for appending
+	// a log for an older generation is discarded, and a torn tail is cut off; a log for a newer generation is
+	// left as it is and open fails
+	bool open(const std::string& filename, uint32_t generation, const Apply& apply);
+	void close() { out.close(); }
+
+	// only replays the records, for a session that must leave the files as they were: a missing log is not
+	// created, a stale or torn one is not rewritten (its valid records are still applied), and append fails
+	void replay(const std::string& filename, uint32_t generation, const Apply& apply);
+
+	bool append(const std::string& word, int delta);
+
+	// after the updates were written into a dictionary image of the given generation, start an empty log for it
+	bool reset(uint32_t generation);
+
+	// records in the log, replayed ones included; the owner compacts once this grows large
+	size_t record_count() const { return records; }
+
+private:
+
+	std::string filename;
+	std::ofstream out;
+	size_t records = 0;
+
+	enum class LogState {
+		CURRENT, // holds exactly the records for the generation
+		REPAIR,  // missing, unreadable or torn: rewritten with its valid records
+		OLDER,   // written against an older image, its records are already in the dictionary
+		NEWER    // written against a newer image than the one opened
+	};
+
+	// applies the records written against generation and collects their raw bytes in valid_records
+	LogState read_records(uint32_t generation, const Apply& apply, std::string& valid_records);
+	bool write_header(std::ofstream& stream, uint32_t generation) const;
+	static uint32_t checksum(const std::string& word, int32_t delta);
+};
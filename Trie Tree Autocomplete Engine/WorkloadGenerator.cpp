@@ -0,0 +1,300 @@
+#include "WorkloadGenerator.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+
+namespace {
+
+	const uint32_t NO_WORD = UINT32_MAX;
+
+	// the dictionary lowercases every identifier and the Trie keeps its letters only (see Trie::insert),
+	// so a letter is stored as its lowercase and anything else is not stored (0)
+	char stored_letter(char ch)
+	{
+		return std::isalpha(static_cast<unsigned char>(ch)) ? static_cast<char>(std::tolower(static_cast<unsigned char>(ch))) : 0;
+	}
+
+	std::string stored_form(const std::string& identifier)
+	{
+		std::string stored;
+		for (char ch : identifier) {
+			if (stored_letter(ch)) stored.push_back(stored_letter(ch));
+		}
+		return stored;
+	}
+
+	std::string lowercase(std::string identifier)
+	{
+		for (char& ch : identifier) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+		return identifier;
+	}
+
+	// FNV-1a
+	uint64_t hash_of(const std::string& text)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (char ch : text) {
+			hash ^= static_cast<unsigned char>(ch);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// an index drawn with the weights whose running totals are cumulative
+	size_t pick_weighted(const std::vector<uint64_t>& cumulative, WorkloadRandom& random)
+	{
+		return std::upper_bound(cumulative.begin(), cumulative.end(), random.below(cumulative.back())) - cumulative.begin();
+	}
+}
+
+uint64_t WorkloadRandom::next()
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+uint64_t WorkloadRandom::below(uint64_t bound)
+{
+	// values under threshold would make the low remainders more likely, they are drawn again
+	uint64_t threshold = (0 - bound) % bound;
+	while (true) {
+		uint64_t value = next();
+		if (value >= threshold) return value % bound;
+	}
+}
+
+double WorkloadRandom::unit()
+{
+	return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions& options) : options(options), offsets{ 0 }
+{
+	WorkloadRandom random(options.seed);
+	std::vector<std::string> parts = make_parts(random);
+
+	// the first parts follow 1 / rank, so part 0 starts twice as many words as part 1
+	std::vector<uint64_t> first_part_weights(parts.size());
+	for (size_t p = 0; p < parts.size(); ++p) {
+		first_part_weights[p] = (p > 0 ? first_part_weights[p - 1] : 0) + (1u << 20) / (p + 1);
+	}
+
+	// open addressing over word indices, at most half full, so a repeated stored word is found and drawn again
+	size_t capacity = 16;
+	while (capacity < options.words * 2) capacity <<= 1;
+	std::vector<uint32_t> table(capacity, NO_WORD);
+
+	offsets.reserve(options.words + 1);
+	while (size() < options.words) {
+		std::string identifier = make_identifier(parts, first_part_weights, random);
+		std::string stored = stored_form(identifier);
+
+		size_t slot = hash_of(stored) & (capacity - 1);
+		while (table[slot] != NO_WORD && !stored_equal(table[slot], stored)) slot = (slot + 1) & (capacity - 1);
+		if (table[slot] != NO_WORD) continue;
+
+		table[slot] = static_cast<uint32_t>(size());
+		text += identifier;
+		offsets.push_back(text.size());
+	}
+
+	cumulative_frequency.resize(size());
+	uint64_t total = 0;
+	for (size_t i = 0; i < size(); ++i) cumulative_frequency[i] = total += static_cast<uint64_t>(frequency(i));
+}
+
+std::vector<std::string> WorkloadGenerator::make_parts(WorkloadRandom& random) const
+{
+	static const char CONSONANTS[] = "bcdfghjklmnprstvwxz";
+	static const char VOWELS[] = "aeiouy";
+
+	// enough parts that four of them combine into far more identifiers than are needed, few enough to be shared
+	size_t count = 64 + 2 * static_cast<size_t>(std::sqrt(static_cast<double>(options.words)));
+	std::vector<std::string> parts(count);
+	for (std::string& part : parts) {
+		// one to three syllables, so the parts read like the words identifiers are made of
+		size_t syllables = 1 + random.below(3);
+		for (size_t s = 0; s < syllables; ++s) {
+			part.push_back(CONSONANTS[random.below(sizeof(CONSONANTS) - 1)]);
+			part.push_back(VOWELS[random.below(sizeof(VOWELS) - 1)]);
+		}
+		if (random.below(2)) part.push_back(CONSONANTS[random.below(sizeof(CONSONANTS) - 1)]);
+	}
+	return parts;
+}
+
+std::string WorkloadGenerator::make_identifier(const std::vector<std::string>& parts, const std::vector<uint64_t>& first_part_weights, WorkloadRandom& random) const
+{
+	// mostly two or three parts, like get_value or parseHeaderLine
+	uint64_t roll = random.below(100);
+	size_t part_count = roll < 10 ? 1 : roll < 55 ? 2 : roll < 90 ? 3 : 4;
+
+	IdentifierStyle style = options.style;
+	if (style == IdentifierStyle::MIXED) style = random.below(2) ? IdentifierStyle::SNAKE : IdentifierStyle::CAMEL;
+
+	std::string identifier = parts[pick_weighted(first_part_weights, random)];
+	for (size_t i = 1; i < part_count; ++i) {
+		std::string part = parts[random.below(parts.size())];
+		if (style == IdentifierStyle::SNAKE) identifier.push_back('_');
+		if (style == IdentifierStyle::CAMEL) part[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(part[0])));
+		identifier += part;
+	}
+	return identifier;
+}
+
+std::string WorkloadGenerator::word(size_t i) const
+{
+	return text.substr(offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+std::string WorkloadGenerator::dictionary_word(size_t i) const
+{
+	return lowercase(word(i));
+}
+
+std::string WorkloadGenerator::stored_word(size_t i) const
+{
+	return stored_form(word(i));
+}
+
+int WorkloadGenerator::frequency(size_t i) const
+{
+	if (options.zipf_exponent == 1.0) {
+		// integer division, the common case does not depend on how a platform rounds pow
+		return std::max(1, options.max_frequency / static_cast<int>(std::min<size_t>(i + 1, INT32_MAX)));
+	}
+	return std::max(1, static_cast<int>(options.max_frequency / std::pow(static_cast<double>(i + 1), options.zipf_exponent)));
+}
+
+std::vector<size_t> WorkloadGenerator::stored_order() const
+{
+	// sorted by the first eight stored letters packed into one integer, which decides almost every comparison
+	// without touching the words themselves; ties are compared in full
+	std::vector<std::pair<uint64_t, size_t>> keys(size());
+	for (size_t i = 0; i < size(); ++i) {
+		uint64_t key = 0;
+		int letters = 0;
+		for (size_t c = offsets[i]; c < offsets[i + 1] && letters < 8; ++c) {
+			char letter = stored_letter(text[c]);
+			if (!letter) continue;
+			key |= static_cast<uint64_t>(static_cast<unsigned char>(letter)) << (56 - 8 * letters++);
+		}
+		keys[i] = std::make_pair(key, i);
+	}
+	std::sort(keys.begin(), keys.end(), [this](const std::pair<uint64_t, size_t>& a, const std::pair<uint64_t, size_t>& b) {
+		if (a.first != b.first) return a.first < b.first;
+		return stored_less(a.second, b.second);
+	});
+
+	std::vector<size_t> order(size());
+	for (size_t i = 0; i < size(); ++i) order[i] = keys[i].second;
+	return order;
+}
+
+std::vector<std::pair<std::string, int>> WorkloadGenerator::get_words() const
+{
+	std::vector<std::pair<std::string, int>> words;
+	words.reserve(size());
+	for (size_t i : stored_order()) words.emplace_back(dictionary_word(i), frequency(i));
+	return words;
+}
+
+bool WorkloadGenerator::stored_less(size_t i, size_t j) const
+{
+	const char* a = text.data() + offsets[i];
+	const char* a_end = text.data() + offsets[i + 1];
+	const char* b = text.data() + offsets[j];
+	const char* b_end = text.data() + offsets[j + 1];
+
+	while (true) {
+		while (a != a_end && !stored_letter(*a)) ++a;
+		while (b != b_end && !stored_letter(*b)) ++b;
+		if (a == a_end || b == b_end) return a == a_end && b != b_end;
+		if (stored_letter(*a) != stored_letter(*b)) return stored_letter(*a) < stored_letter(*b);
+		++a;
+		++b;
+	}
+}
+
+bool WorkloadGenerator::stored_equal(size_t i, const std::string& stored) const
+{
+	size_t position = 0;
+	for (size_t c = offsets[i]; c < offsets[i + 1]; ++c) {
+		char letter = stored_letter(text[c]);
+		if (!letter) continue;
+		if (position == stored.size() || letter != stored[position]) return false;
+		++position;
+	}
+	return position == stored.size();
+}
+
+std::vector<WorkloadQuery> WorkloadGenerator::make_queries(const QueryOptions& query_options) const
+{
+	std::vector<WorkloadQuery> queries;
+	if (size() == 0) return queries;
+	queries.reserve(query_options.count);
+
+	// every stream gets its own generator, so a stream does not depend on the streams drawn before it
+	WorkloadRandom random(options.seed ^ (0xd1b54a32d192ed03ull * (query_options.stream + 1)));
+	while (queries.size() < query_options.count) {
+		WorkloadQuery query{ std::string(), pick_weighted(cumulative_frequency, random), 0 };
+		std::string stored = stored_word(query.word);
+
+		size_t typed = stored.size();
+		if (!query_options.whole_words && typed > 2) typed = 2 + random.below(typed - 1);
+
+		for (size_t i = 0; i < typed; ++i) {
+			if (query.typos >= query_options.max_typos || random.unit() >= query_options.typo_rate) {
+				query.input.push_back(stored[i]);
+				continue;
+			}
+
+			++query.typos;
+			switch (random.below(3)) {
+			case 0: // another letter instead
+				query.input.push_back(static_cast<char>('a' + (stored[i] - 'a' + 1 + random.below(25)) % 26));
+				break;
+			case 1: // a letter too many
+				query.input.push_back(static_cast<char>('a' + random.below(26)));
+				query.input.push_back(stored[i]);
+				break;
+			default: // the letter left out
+				break;
+			}
+		}
+
+		if (query.input.empty()) continue; // every letter typed was left out, drawn again
+		queries.push_back(std::move(query));
+	}
+	return queries;
+}
+
+bool WorkloadGenerator::save_dictionary(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	for (size_t i : stored_order()) {
+		out << dictionary_word(i) << ' ' << frequency(i) << '\n';
+	}
+	if (!out) {
+		std::cerr << "Failed to write " << filename << ".\n";
+		return false;
+	}
+	return true;
+}
+
+bool WorkloadGenerator::save_queries(const std::string& filename, const std::vector<WorkloadQuery>& queries) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	for (const WorkloadQuery& query : queries) {
+		out << query.input << ' ' << stored_word(query.word) << ' ' << query.typos << '\n';
+	}
+	if (!out) {
+		std::cerr << "Failed to write " << filename << ".\n";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+// SplitMix64 with its own integer and real draws. The <random> distributions are implementation defined,
+// so the same seed gives the same workload on every compiler and platform only without them.
+class WorkloadRandom {
+
+public:
+
+	explicit WorkloadRandom(uint64_t seed) : state(seed) {}
+
+	uint64_t next();
+
+	// uniform in [0, bound), bound > 0
+	uint64_t below(uint64_t bound);
+
+	// uniform in [0, 1), 53 random bits
+	double unit();
+
+private:
+
+	uint64_t state;
+};
+
+enum class IdentifierStyle {
+	LOWER, // getvalue
+	SNAKE, // get_value
+	CAMEL, // getValue
+	MIXED  // snake_case or camelCase, picked per word
+};
+
+struct WorkloadOptions {
+	uint64_t seed = 42;
+	size_t words = 100000;
+	IdentifierStyle style = IdentifierStyle::MIXED;
+	double zipf_exponent = 1.0; // the word of rank r gets max_frequency / r^zipf_exponent, at least 1
+	int max_frequency = 1000000;
+};
+
+struct QueryOptions {
+	size_t count = 10000;
+	double typo_rate = 0.0;   // chance of a typo at each typed letter
+	int max_typos = 2;        // typos per query at most, so a query is never further than this from its word
+	bool whole_words = false; // every query types its word in full instead of a prefix of it
+	uint64_t stream = 0;      // independent query streams over the same dictionary
+};
+
+struct WorkloadQuery {
+	std::string input; // as typed, lowercase letters only
+	size_t word;       // rank - 1 of the word the user was typing
+	int typos;         // substitutions, insertions and deletions in input, each one edit
+};
+
+// Deterministic dictionaries of identifiers and query streams over them, the same for the same options everywhere.
+// Identifiers are made of one to four parts from a shared pool. Their first parts follow a Zipf distribution
+// (a few like "get" and "set" start a large share of all words), so many words share their prefixes.
+// Words are distinct as the Trie stores them: the dictionary lowercases them and the Trie keeps letters only, so
+// "get_value" and "getValue" are both stored as "getvalue". Word i has rank i + 1, the most frequent word comes first.
+// The words are kept in one buffer with an offset each, so 10^7 words take a few hundred megabytes.
+class WorkloadGenerator {
+
+public:
+
+	explicit WorkloadGenerator(const WorkloadOptions& options);
+
+	size_t size() const { return offsets.size() - 1; }
+
+	// word i as generated, as the dictionary holds it (lowercased, or the Trie would drop the capitals of
+	// camelCase) and as the Trie stores it
+	std::string word(size_t i) const;
+	std::string dictionary_word(size_t i) const;
+	std::string stored_word(size_t i) const;
+	int frequency(size_t i) const;
+
+	// every word with its frequency, sorted as the Trie stores them like Trie::get_all_words, so Trie::load_words
+	// bulk-builds them
+	std::vector<std::pair<std::string, int>> get_words() const;
+
+	// the same queries for the same options, whatever was generated before
+	// Queries pick their word with its frequency, type a prefix of it (at least two letters, or the whole word),
+	// and make a typo at each letter with typo_rate chance: a substituted, an inserted or a dropped letter.
+	std::vector<WorkloadQuery> make_queries(const QueryOptions& query_options) const;
+
+	// "word frequency" lines in the same order, for Trie::load_from_file
+	bool save_dictionary(const std::string& filename) const;
+
+	// "input word typos" lines, word as the Trie stores it
+	bool save_queries(const std::string& filename, const std::vector<WorkloadQuery>& queries) const;
+
+private:
+
+	WorkloadOptions options;
+	std::string text;            // every word, back to back
+	std::vector<size_t> offsets; // word i is text[offsets[i], offsets[i + 1])
+
+	std::vector<uint64_t> cumulative_frequency; // running totals of the frequencies, queries pick their words by them
+
+	// generation steps, see the constructor
+	std::vector<std::string> make_parts(WorkloadRandom& random) const;
+	std::string make_identifier(const std::vector<std::string>& parts, const std::vector<uint64_t>& first_part_weights, WorkloadRandom& random) const;
+
+	// orders words i and j as the Trie stores them without building the stored words
+	bool stored_less(size_t i, size_t j) const;
+	std::vector<size_t> stored_order() const;
+	bool stored_equal(size_t i, const std::string& stored) const;
+};
@@ -1,11 +1,41 @@
 #include "MainLogicController.h"
 
-int main() {
+// usage: console [--record trace.txt] | [--replay trace.txt [--latencies latencies.txt]]
+//   --record   types as usual and writes every keystroke with its time to the trace
+//   --replay   runs a recorded trace without the console and reports per-keystroke latency; nothing is saved
+int main(int argc, char* argv[]) {
 
     MainLogicController controller;
 
-    // Step 1: Load dictionary
-    controller.start_program();
+    std::string record_file, replay_file, latency_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << ".\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--record") record_file = value;
+        else if (option == "--replay") replay_file = value;
+        else if (option == "--latencies") latency_file = value;
+        else {
+            std::cerr << "Unknown option " << option << ".\n";
+            return 1;
+        }
+    }
+
+    // Step 1: Load dictionary (only read when replaying)
+    controller.start_program(!replay_file.empty());
+
+    if (!replay_file.empty()) {
+        // the dictionary files are left as they were, so the same trace replays the same way again
+        return controller.replay_trace(replay_file, latency_file) ? 0 : 1;
+    }
+
+    if (!record_file.empty() && !controller.start_recording(record_file)) {
+        return 1;
+    }
 
     // Step 2: Start user interaction loop
     controller.interactive_loop();